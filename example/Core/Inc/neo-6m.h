@@ -8,6 +8,7 @@
 #ifndef INC_NEO_6M_H_
 #define INC_NEO_6M_H_
 
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,14 +16,114 @@
 #include "main.h"
 
 
-#define RX_BUFFER_SIZE						100
+#define NMEA_MAX_SENTENCE_LENGTH			82		/*!< Maximum length of NMEA sentence, including '$' and end sequence */
+#define NMEA_MAX_PROPRIETARY_LENGTH			400		/*!< Maximum length of PUBX sentence, must be less than RX_RING_SIZE */
+
+#define NMEA_ADDRESS_LENGTH					5		/*!< Length of the address field (talker and formatter) */
+#define NMEA_ADDRESS_PACK(packed, c)		(((packed) << 6) | ((c) & 0x3F))	/*!< Packs next address character */
+#define NMEA_FORMATTER_MASK					0x3FFFF	/*!< Formatter (last 3 characters) of the packed address */
+#define NMEA_TALKER_SHIFT					18		/*!< Shift of the talker (first 2 characters) in the packed address */
 
 #define END_SEQUENCE 						"\r\n"
 
-#define EXPECTED_MESSAGES_BUFF_SIZE			12
 
-extern UART_HandleTypeDef *gps_uart;
-#define GPS_UART						    gps_uart
+/*
+ * Receive modes
+ * @receive_modes
+ */
+#define NEO6M_RECEIVE_IT					0		/*!< One UART interrupt per received byte */
+#define NEO6M_RECEIVE_DMA					1		/*!< Circular DMA, library wakes up on idle line, half and full transfer */
+#define NEO6M_RECEIVE_LL					2		/*!< One UART interrupt per received byte, data register is read
+															 directly with LL driver, bypassing HAL UART */
+
+#ifndef NEO6M_RECEIVE_MODE
+#define NEO6M_RECEIVE_MODE					NEO6M_RECEIVE_IT
+#endif
+
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_LL
+#include "stm32f4xx_ll_usart.h"
+#endif
+
+/*
+ * Numeric formats of the packages
+ */
+#define NEO6M_NUMERIC_FLOAT					0		/*!< Coordinates are double (degrees), other values are float */
+#define NEO6M_NUMERIC_FIXED					1		/*!< Coordinates are int32_t (1e-7 degrees), other values are int32_t
+															 scaled by NEO6M_FIXED_SCALE, no floating point is used */
+
+#ifndef NEO6M_NUMERIC_FORMAT
+#define NEO6M_NUMERIC_FORMAT				NEO6M_NUMERIC_FLOAT
+#endif
+
+#define NEO6M_COORD_SCALE					10000000	/*!< Scale of fixed point coordinates, 1e-7 degrees */
+#define NEO6M_FIXED_SCALE					1000		/*!< Scale of other fixed point values, e.g. mm for meters */
+
+#define RX_RING_SIZE						512		/*!< Size of the receive ring (circular DMA buffer in DMA mode),
+															 must be power of two */
+
+#define SENTENCE_QUEUE_SIZE					8		/*!< Count of received sentences waiting for processing,
+															 must be power of two */
+
+#define NEO6M_MAX_FIELDS					20		/*!< Maximum count of sentence fields, that positions are recorded for */
+#define NEO6M_PUBX_MAX_SV					16		/*!< Maximum count of satellites in PUBX,03 package */
+
+#define NEO6M_MAX_PRN						64		/*!< Maximum PRN in the sky table (GPS 1..32, SBAS 33..64),
+															 satellites are kept in 64-bit masks */
+#define NEO6M_SATELLITE_MAX_AGE				3		/*!< Count of GSV cycles, after which satellite that isn't
+															 reported anymore is removed from the sky table */
+
+#define NEO6M_UART_COUNT					16		/*!< Count of UART instances that could be used with receivers */
+
+#define NEO6M_CONFIG_TIMEOUT				1500	/*!< Time (ms) to wait for the module response after configuration */
+
+#define NEO6M_MIN_MEAS_RATE					200		/*!< Minimum measurement period (ms), NEO-6M supports up to 5 Hz */
+#define NEO6M_MAX_UART_LOAD					90		/*!< Maximum UART load (%), allowed by navigation rate */
+
+#define NEO6M_AIDING_PERIOD					1800000	/*!< Period (ms) of polling aiding data to save it, with NEO_TRACK_AIDING */
+#define NEO6M_AIDING_MAX_SV					32		/*!< Count of GPS satellites, that aiding data is polled for */
+#define NEO6M_AIDING_TIMEOUT				10000	/*!< Time (ms) to receive aiding data after the poll, then saving is finished */
+
+
+/*
+ * UBX protocol
+ */
+#define UBX_SYNC_CHAR_1						0xB5
+#define UBX_SYNC_CHAR_2						0x62
+
+#define UBX_MAX_PAYLOAD						256		/*!< Frames with longer payload are dropped */
+
+#define UBX_CLASS_ACK						0x05
+#define UBX_ACK_NAK							0x00
+#define UBX_ACK_ACK							0x01
+
+#define UBX_CLASS_CFG						0x06
+#define UBX_CFG_PRT							0x00
+#define UBX_CFG_MSG							0x01
+#define UBX_CFG_RATE						0x08
+
+#define UBX_CLASS_NAV						0x01
+#define UBX_NAV_POSLLH						0x02
+#define UBX_NAV_DOP							0x04
+#define UBX_NAV_SOL							0x06
+#define UBX_NAV_VELNED						0x12
+#define UBX_NAV_TIMEUTC						0x21
+
+#define UBX_CLASS_AID						0x0B
+#define UBX_AID_INI							0x01
+#define UBX_AID_ALM							0x30
+#define UBX_AID_EPH							0x31
+
+#define UBX_AID_INI_POS						0x00000001	/*!< AID-INI flags, position is valid */
+#define UBX_AID_INI_LLA						0x00000020	/*!< AID-INI flags, position is given in lat/long/alt */
+#define UBX_AID_INI_ALT_INV					0x00000040	/*!< AID-INI flags, altitude is not valid */
+
+#define UBX_CLASS_NMEA						0xF0
+#define UBX_CLASS_PUBX						0xF1
+
+#define UBX_PORT_UART1						1
+#define UBX_PORT_MODE_8N1					0x000008D0
+#define UBX_PROTO_UBX						0x0001
+#define UBX_PROTO_NMEA						0x0002
 
 
 /*
@@ -37,10 +138,51 @@ typedef enum
 	GSA,
 	GSV,
 	RMC,
-	VTG
+	VTG,
+	DTM,
+	GBS,
+	PUBX00,									/*!< u-blox proprietary, output only when polled */
+	PUBX03,									/*!< u-blox proprietary, output only when polled */
+	PUBX04,									/*!< u-blox proprietary, output only when polled */
+	NAV_POSLLH,								/*!< UBX binary */
+	NAV_VELNED,								/*!< UBX binary */
+	NAV_SOL,								/*!< UBX binary */
+	NAV_TIMEUTC,							/*!< UBX binary */
+	NAV_DOP,								/*!< UBX binary */
+	AID_INI,								/*!< UBX binary, output only when polled */
+	AID_ALM,								/*!< UBX binary, output only when polled, message per satellite */
+	AID_EPH									/*!< UBX binary, output only when polled, message per satellite */
 }MessagesTypes_t;
 
 
+/*
+ * Talkers of NMEA messages, bit per talker
+ * @talkers
+ */
+typedef enum
+{
+	NEO_TALKER_GP = 0x01,					/*!< GPS */
+	NEO_TALKER_GL = 0x02,					/*!< GLONASS */
+	NEO_TALKER_GA = 0x04,					/*!< Galileo */
+	NEO_TALKER_BD = 0x08,					/*!< BeiDou, $BD or $GB */
+	NEO_TALKER_GN = 0x10,					/*!< Combined GNSS solution */
+	NEO_TALKER_OTHER = 0x20,				/*!< Any other talker */
+	NEO_TALKER_ALL = 0x3F					/*!< All talkers */
+}Talker_t;
+
+
+/*
+ * Data tracked by the library from received messages, bit per tracker
+ * @trackers
+ */
+typedef enum
+{
+	NEO_TRACK_SKY = 0x01,					/*!< Satellites database, from GSV and GSA messages */
+	NEO_TRACK_EPOCH = 0x02,					/*!< Navigation solution of the epoch, from RMC, VTG, GGA and GSA messages */
+	NEO_TRACK_AIDING = 0x04					/*!< Aiding data, polled each NEO6M_AIDING_PERIOD and saved to non-volatile memory */
+}Tracker_t;
+
+
 typedef enum
 {
 	NEO_FREE,								/*!< MCU doesn't receive any messages */
@@ -51,20 +193,186 @@ typedef enum
 typedef struct
 {
 	MessagesTypes_t type;   				/*!< Message type */
-    char formatter[7];         				/*!< Sentence formatter, defines the message content */
+    char formatter[9];         				/*!< Sentence formatter, defines the message content */
     void (*callback)(void* arg); 			/*!< Appropriate call back function */
 } NMEA_StandardMessage_t;
 
 
+/*
+ * Numeric types of decoded values, selected by NEO6M_NUMERIC_FORMAT
+ */
+#if NEO6M_NUMERIC_FORMAT == NEO6M_NUMERIC_FIXED
+typedef int32_t NEO6M_Coord_t;				/*!< Latitude or longitude, 1e-7 degrees, negative for S and W */
+typedef int32_t NEO6M_Real_t;				/*!< Value with fractional part, scaled by NEO6M_FIXED_SCALE */
+#else
+typedef double NEO6M_Coord_t;				/*!< Latitude or longitude, degrees, negative for S and W */
+typedef float NEO6M_Real_t;					/*!< Value with fractional part */
+#endif
+
+
+/*
+ * Result of UBX-CFG messages
+ */
+typedef enum
+{
+	NEO_ACK_NONE,							/*!< Module hasn't answered yet */
+	NEO_ACK_ACK,							/*!< Message was accepted (UBX-ACK-ACK) */
+	NEO_ACK_NAK								/*!< Message was rejected (UBX-ACK-NAK) */
+}AckStatus_t;
+
+
+/*
+ * Received sentence, that is placed in the receive ring
+ */
+typedef struct
+{
+	const char *data[2];					/*!< Segments of the sentence, second one is used only when the sentence
+												 wraps around the end of the receive ring */
+	uint16_t length[2];						/*!< Lengths of the segments */
+	const uint8_t *fields;					/*!< Positions of the fields in the sentence */
+	uint8_t fieldsCount;					/*!< Count of the fields */
+	uint8_t checksum;						/*!< Checksum received after '*' */
+}NEO6M_SentenceView_t;
+
+
+typedef struct
+{
+	NEO6M_SentenceView_t view;				/*!< Received sentence, fields are decoded from it on demand */
+	MessagesTypes_t type;					/*!< Type of the message */
+	char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
+	uint8_t kinds[NEO6M_MAX_FIELDS];		/*!< Kinds of cached values of the fields, 0 - not decoded yet */
+	int32_t values[NEO6M_MAX_FIELDS];		/*!< Cached values of the fields */
+}NEO6M_Sentence_t;
+
+
 typedef struct
 {
-	NMEA_StandardMessage_t expectedMessages[EXPECTED_MESSAGES_BUFF_SIZE];	/*!< Array of NMEA messages types,
-																				 that expects by user */
-	uint8_t expectedMessagesCount;			/*!< Count of expected messages */
+	uint32_t start;							/*!< Position of the sentence start in the received stream */
+	uint16_t length;						/*!< Length of the sentence, including end sequence */
+	uint8_t type;							/*!< Type of the sentence, see @messages_types, EMPTY - unsupported */
+	uint8_t talker;							/*!< Talker of the sentence, see @talkers */
+	uint8_t checksum;						/*!< Checksum received after '*' */
+	uint8_t fieldsCount;					/*!< Count of the fields, that positions are recorded */
+	uint8_t fields[NEO6M_MAX_FIELDS];		/*!< Positions of the fields (after ',') in the sentence */
+}NEO6M_SentenceSlot_t;
+
+
+typedef struct
+{
+	uint32_t sentences;						/*!< Count of received sentences */
+	uint32_t dropped;						/*!< Count of sentences dropped because the queue or the receive ring was full */
+	uint32_t overwritten;					/*!< Count of sentences overwritten by DMA in the receive ring before processing */
+	uint32_t overflows;						/*!< Count of sentences dropped because they exceed NMEA_MAX_SENTENCE_LENGTH */
+	uint32_t corrupted;						/*!< Count of sentences dropped because of invalid or missing checksum */
+	uint32_t resyncs;						/*!< Count of sentences restarted by '$' before the end sequence */
+	uint32_t garbage;						/*!< Count of bytes received outside of sentences */
+	uint32_t errors;						/*!< Count of UART errors (overrun, noise, framing) */
+	uint32_t ubxFrames;						/*!< Count of received UBX frames with valid checksum */
+	uint32_t ubxCorrupted;					/*!< Count of UBX frames dropped because of invalid checksum */
+	uint32_t ubxOverflows;					/*!< Count of UBX frames dropped because payload exceeds UBX_MAX_PAYLOAD */
+}NEO6M_Statistics_t;
+
+
+/*
+ * Satellite in view
+ */
+typedef struct
+{
+	uint8_t sv;								/*!< Satellite ID */
+	uint8_t elv;							/*!< Elevation, range 0..90 */
+	uint16_t az;							/*!< Azimuth, range 0..359 */
+	uint8_t cno;							/*!< C/N0, range 0..99, null when not tracking */
+}SV_Info_t;
+
+
+/*
+ * Satellites database, assembled from GSV and GSA messages.
+ * Arrays are indexed by PRN - 1, satellite with PRN n is in view if bit n - 1 of visible is set.
+ */
+typedef struct
+{
+	uint64_t visible;						/*!< Satellites in view, bit per PRN */
+	uint64_t used;							/*!< Satellites used in navigation solution (GSA), bit per PRN */
+	uint8_t elevation[NEO6M_MAX_PRN];		/*!< Elevation, range 0..90 */
+	uint16_t azimuth[NEO6M_MAX_PRN];		/*!< Azimuth, range 0..359 */
+	uint8_t cno[NEO6M_MAX_PRN];				/*!< C/N0, range 0..99, 0 when not tracking */
+	uint16_t lastSeen[NEO6M_MAX_PRN];		/*!< GSV cycle, in which satellite was reported last time */
+	uint16_t epoch;							/*!< Count of completed GSV cycles */
+	uint8_t inView;							/*!< Satellites in view, reported by the module */
+}NEO6M_Sky_t;
+
+
+/*
+ * Navigation solution, merged from all messages of the same epoch (UTC time)
+ */
+typedef struct
+{
+	uint32_t messages;						/*!< Messages merged into the solution, bit per message type */
+	uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight (RMC, GGA) */
+	int64_t epoch;							/*!< Date and time as Unix time (ms), 0 if unknown (RMC) */
+	char status;							/*!< Status, V=Navigation receiver warning, A=Data valid (RMC) */
+	uint8_t fs;								/*!< Position Fix Status Indicator (GGA) */
+	uint8_t navMode;						/*!< Navigation mode, 1=No fix, 2=2D fix, 3=3D fix (GSA) */
+	uint8_t noSV;							/*!< Satellites used in navigation solution (GGA) */
+	NEO6M_Coord_t latitude;					/*!< Latitude, degrees (RMC, GGA) */
+	NEO6M_Coord_t longitude;				/*!< Longitude, degrees (RMC, GGA) */
+	NEO6M_Real_t msl;						/*!< MSL Altitude, meters (GGA) */
+	NEO6M_Real_t altref;					/*!< Geoid Separation, meters (GGA) */
+	NEO6M_Real_t sog;						/*!< Speed over ground, knots (RMC, VTG) */
+	NEO6M_Real_t kph;						/*!< Speed over ground, kilometers per hour (VTG) */
+	NEO6M_Real_t cog;						/*!< Course over ground (true), degrees (RMC, VTG) */
+	NEO6M_Real_t pdop;						/*!< Position dilution of precision (GSA) */
+	NEO6M_Real_t hdop;						/*!< Horizontal dilution of precision (GSA, GGA) */
+	NEO6M_Real_t vdop;						/*!< Vertical dilution of precision (GSA) */
+}NEO6M_NavSolution_t;
+
+
+typedef struct
+{
+	UART_HandleTypeDef *huart;				/*!< UART handle used with the module */
+	uint32_t subscriptions;					/*!< Messages types, that expects by user, bit per type */
+	uint32_t sentenceSubscriptions;			/*!< Messages types, that expects by user as sentences, bit per type */
+	uint8_t talkers;						/*!< Talkers, that messages are accepted from, see @talkers */
+	uint32_t trackingSubscriptions;			/*!< Messages types, that trackers need, bit per type */
+	uint8_t trackers;						/*!< Enabled trackers, see @trackers */
+	NEO6M_Sky_t sky;						/*!< Satellites database, updated if NEO_TRACK_SKY is enabled */
+	NEO6M_NavSolution_t navSolution;		/*!< Solution of the epoch being merged, if NEO_TRACK_EPOCH is enabled */
+	uint32_t navStart;						/*!< Tick, when the first message of the epoch was merged */
+	uint32_t navLastTime;					/*!< UTC time (ms) of the last delivered epoch, UINT32_MAX - unknown */
+	uint8_t navLate;						/*!< 1 - late messages of the last delivered epoch are dropped */
+	uint8_t navTimeKnown;					/*!< 1 - UTC time of the epoch being merged was received (not empty) */
+	uint32_t aidingPolled;					/*!< Tick, when aiding data was polled last time, if NEO_TRACK_AIDING is enabled */
+	uint32_t aidingOffset;					/*!< Size of aiding data, that was saved since the last poll */
+	uint8_t aidingChecksum[2];				/*!< Checksum of aiding data, that was saved since the last poll */
+	uint8_t aidingSaving;					/*!< 1 - aiding data is being received after the poll */
 	ReceiveStatus_t receive_status;			/*!< Receive status (expects new messages or not) */
+	volatile uint8_t rxArmed;				/*!< 1 - receiving is started (messages are expected or module is configured) */
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_DMA
+	uint16_t dmaPos;						/*!< Position in the receive ring up to which DMA bytes were handled */
+#elif NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_IT
 	char rcvdByte;							/*!< Variable for receiving messages byte by byte */
-	char rxBuff[RX_BUFFER_SIZE];			/*!< Receive buffer */
-	size_t rxCounter;						/*!< Counter of bytes that were receive */
+#endif
+	uint8_t rxRing[RX_RING_SIZE];			/*!< Receive ring, sentences are parsed directly from it */
+	volatile uint32_t rxTotal;				/*!< Count of bytes that were received, position of the next byte */
+	NEO6M_SentenceSlot_t rxQueue[SENTENCE_QUEUE_SIZE];	/*!< Queue of received sentences */
+	volatile uint8_t queueHead;				/*!< Index of the next received sentence, written only by receiving */
+	volatile uint8_t queueTail;				/*!< Index of the oldest received sentence, written only by processing */
+	size_t rxCounter;						/*!< Length of the sentence being received, 0 - waiting for '$' */
+	uint32_t rxAddress;						/*!< Talker and formatter of the sentence being received, packed */
+	uint8_t rxChecksum;						/*!< Checksum of the sentence being received, computed */
+	uint8_t rxChecksumField;				/*!< 1 - checksum field ('*') of the sentence is being received */
+	NEO6M_Statistics_t stats;				/*!< Receiving statistics */
+	uint8_t ubxState;						/*!< State of UBX frame receiving, 0 - no frame is received */
+	uint8_t ubxHeader[4];					/*!< Class, ID and length of the UBX frame being received */
+	uint8_t ubxPayload[2];					/*!< First bytes of the UBX frame payload */
+	uint16_t ubxCounter;					/*!< Count of payload bytes, that were received */
+	uint8_t ubxChecksum[2];					/*!< Checksum of the UBX frame being received */
+	uint8_t ubxDropped;						/*!< 1 - UBX frame being received isn't placed in the full receive ring */
+	uint8_t queueAll;						/*!< 1 - unexpected sentences are queued too (baud rate switch is verified) */
+	volatile uint16_t ackMessage;			/*!< Class and ID of the last acknowledged message */
+	volatile AckStatus_t ackStatus;			/*!< Status of the last acknowledged message */
+	uint8_t moduleFiltering;				/*!< 1 - module outputs only expected messages */
+	uint16_t measRate;						/*!< Measurement period (ms) set in the module, 0 - default (1000 ms) */
 }NEO6M_Handle_t;
 
 
@@ -77,14 +385,15 @@ typedef struct
  */
 typedef struct
 {
+	char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
 	char lll[4];							/*!< Local Datum Code, W84 = WGS84, W72 = WGS72, 999 = user defined */
 	char lsd[5];							/*!< Local Datum Subdivision Code, This field outputs the currently
 											     selected Datum as a string (see alsonote above). */
-	float lat;								/*!< Offset in Latitude */
+	NEO6M_Real_t lat;						/*!< Offset in Latitude */
 	char ns;								/*!< North/South indicator */
-	float lon;								/*!< Offset in Longitude */
+	NEO6M_Real_t lon;						/*!< Offset in Longitude */
 	char ew;								/*!< East/West indicator */
-	float alt;								/*!< Offset in altitude */
+	NEO6M_Real_t alt;						/*!< Offset in altitude */
 	char rrr[4];							/*!< Reference Datum Code, W84 = WGS 84. This is the only supported Reference datum. */
 	uint16_t cs;							/*!< Checksum */
 }DTM_Package_t;
@@ -95,12 +404,16 @@ typedef struct
  */
 typedef struct
 {
+	char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
 	uint32_t time;							/*!< UTC Time, Time to which this RAIM sentence belongs */
-	float errlat;							/*!< Expected error in latitude */
-	float errlon;							/*!< Expected error in longitude */
-	float erralt;							/*!< Expected error in altitude */
+	uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
+	NEO6M_Real_t errlat;					/*!< Expected error in latitude */
+	NEO6M_Real_t errlon;					/*!< Expected error in longitude */
+	NEO6M_Real_t erralt;					/*!< Expected error in altitude */
 	uint8_t svid;							/*!< Satellite ID of most likely failed satellite */
-	float bias;								/*!< Estimate on most likely failed satellite (a priori residual) */
+	NEO6M_Real_t prob;						/*!< Probability of missed detection, not supported (empty) */
+	NEO6M_Real_t bias;						/*!< Estimate on most likely failed satellite (a priori residual) */
+	NEO6M_Real_t stddev;					/*!< Standard deviation of estimated bias */
 	uint16_t cs;							/*!< Checksum */
 }GBS_Package_t;
 
@@ -110,17 +423,19 @@ typedef struct
  */
 typedef struct
 {
+	char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
 	uint32_t time;							/*!< UTC Time, Current time */
-	double latitude;						/*!< Latitude, Degrees + minutes */
+	uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
+	NEO6M_Coord_t latitude;					/*!< Latitude, degrees */
 	char ns;								/*!< N/S Indicator, N=north or S=south */
-	double longitude;						/*!< Longitude, Degrees + minutes */
+	NEO6M_Coord_t longitude;				/*!< Longitude, degrees */
 	char ew;								/*!< E/W indicator, E=east or W=west */
 	uint8_t fs;								/*!< Position Fix Status Indicator */
 	uint8_t noSV;							/*!< Satellites Used, Range 0 to 12 */
-	float hdop;								/*!< HDOP, Horizontal Dilution of Precision */
-	float msl;								/*!< MSL Altitude */
+	NEO6M_Real_t hdop;						/*!< HDOP, Horizontal Dilution of Precision */
+	NEO6M_Real_t msl;						/*!< MSL Altitude */
 	char uMsl;								/*!< Units, Meters (fixed field) */
-	float altref;							/*!< Geoid Separation */
+	NEO6M_Real_t altref;					/*!< Geoid Separation */
 	char uSep;								/*!< Units, Meters (fixed field) */
 	uint8_t diffAge;						/*!< Age of Differential Corrections, Blank (Null) fields when DGPS is not used */
 	uint8_t diffStation;					/*!< Diff. Reference Station ID */
@@ -133,11 +448,13 @@ typedef struct
  */
 typedef struct
 {
-    double latitude;          				/*!< Latitude, Degrees + minutes */
+    char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
+    NEO6M_Coord_t latitude;					/*!< Latitude, degrees */
     char ns;                  				/*!< N/S Indicator, N=north or S=south */
-    double longitude;         				/*!< Longitude, Degrees + minutes */
+    NEO6M_Coord_t longitude;				/*!< Longitude, degrees */
     char ew;                  				/*!< E/W indicator, E=east or W=west */
     uint32_t time;            				/*!< UTC Time */
+    uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
     char valid;           					/*!< Data Valid status, A=Data valid or V=Data not valid */
     char mode;           					/*!< Positioning Mode */
     uint16_t cs;              				/*!< Checksum */
@@ -149,12 +466,13 @@ typedef struct
  */
 typedef struct
 {
+	char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
 	char sMode;								/*!< Smode */
 	uint8_t fs;              				/*!< Fix status */
 	uint8_t sv[12];							/*!< Satellite number (Repeated block (12 times)) */
-	float pdop;								/*!< Position dilution of precision */
-	float hdop;								/*!< Horizontal dilution of precision */
-	float vdop;								/*!< Vertical dilution of precision */
+	NEO6M_Real_t pdop;						/*!< Position dilution of precision */
+	NEO6M_Real_t hdop;						/*!< Horizontal dilution of precision */
+	NEO6M_Real_t vdop;						/*!< Vertical dilution of precision */
 	uint16_t cs;              				/*!< Checksum */
 }GSA_Package_t;
 
@@ -164,14 +482,7 @@ typedef struct
  */
 typedef struct
 {
-	uint8_t sv;								/*!< Satellite ID */
-	uint8_t elv;							/*!< Elevation, range 0..90 */
-	uint16_t az;							/*!< Azimuth, range 0..359 */
-	uint8_t cno;							/*!< C/N0, range 0..99, null when not tracking */
-}SV_Info_t;
-
-typedef struct
-{
+    char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
     uint8_t noMsg;          				/*!< Number of messages, total number of GPGSV messages being output */
     uint8_t msgNo;          				/*!< Number of this message */
     uint8_t noSV;							/*!< Satellites in View */
@@ -180,21 +491,25 @@ typedef struct
 }GSV_Package_t;
 
 
+
 /*
  * Recommended Minimum data
  */
 typedef struct
 {
+    char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
     uint32_t time;            				/*!< UTC Time */
+    uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
     char status;              				/*!< Status, V=Navigation receiver warning, A=Data valid */
-    double latitude;          				/*!< Latitude, Degrees + minutes */
+    NEO6M_Coord_t latitude;					/*!< Latitude, degrees */
     char ns;                  				/*!< N/S Indicator, N=north or S=south */
-    double longitude;         				/*!< Longitude, Degrees + minutes */
+    NEO6M_Coord_t longitude;				/*!< Longitude, degrees */
     char ew;                  				/*!< E/W indicator, E=east or W=west */
-    float spd;        						/*!< Speed over ground in knots */
-    float cog;         						/*!< Course over ground (true) */
+    NEO6M_Real_t spd;						/*!< Speed over ground in knots */
+    NEO6M_Real_t cog;						/*!< Course over ground (true) */
     uint32_t date;            				/*!< Date */
-    float mv;  								/*!< Magnetic Variation */
+    int64_t epoch;							/*!< Date and time as Unix time (ms), 0 if date is empty */
+    NEO6M_Real_t mv;						/*!< Magnetic Variation */
     char mvE;     		     				/*!< E/W indicator for magnetic variation, E=east or W=west */
     char mode;      						/*!< Mode Indicator (A=Autonomous, D=Differential, E=Estimated, N=Data not valid) */
     uint16_t cs;              				/*!< Checksum */
@@ -207,19 +522,239 @@ typedef struct
  */
 typedef struct
 {
-    float cogt;         					/*!< Course over ground (true) */
+    char talker[3];							/*!< Talker ID, e.g. "GP" or "GN" */
+    NEO6M_Real_t cogt;						/*!< Course over ground (true) */
     char true;								/*!< Fixed field: true */
     uint8_t cogm;         					/*!< Course over ground (magnetic), not output */
     char magnetic;							/*!< Fixed field: magnetic */
-    float sog;         						/*!< Speed over ground */
+    NEO6M_Real_t sog;						/*!< Speed over ground, knots */
     char knots;								/*!< Fixed field: knots */
-    float kph;         						/*!< Speed over ground */
+    NEO6M_Real_t kph;						/*!< Speed over ground, kilometers per hour */
     char kilometers;						/*!< Fixed field: kilometers per hour */
     char mode;								/*!< Mode Indicator */
     uint16_t cs;              				/*!< Checksum */
 }VTG_Package_t;
 
 
+/*********************************************************************************************
+ *								  u-blox proprietary messages
+ ********************************************************************************************/
+
+/*
+ * Lat/Long Position Data
+ */
+typedef struct
+{
+	char talker[3];							/*!< Always "PU" */
+	uint32_t time;							/*!< UTC Time, Current time */
+	uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
+	NEO6M_Coord_t latitude;					/*!< Latitude, degrees */
+	char ns;								/*!< N/S Indicator, N=north or S=south */
+	NEO6M_Coord_t longitude;				/*!< Longitude, degrees */
+	char ew;								/*!< E/W indicator, E=east or W=west */
+	NEO6M_Real_t altRef;					/*!< Altitude above user datum ellipsoid, meters */
+	char navStat[3];						/*!< Navigation Status, e.g. NF=No Fix, G2=2D fix, G3=3D fix */
+	NEO6M_Real_t hAcc;						/*!< Horizontal accuracy estimate, meters */
+	NEO6M_Real_t vAcc;						/*!< Vertical accuracy estimate, meters */
+	NEO6M_Real_t sog;						/*!< Speed over ground, kilometers per hour */
+	NEO6M_Real_t cog;						/*!< Course over ground, degrees */
+	NEO6M_Real_t vVel;						/*!< Vertical velocity, m/s, positive downwards */
+	uint16_t diffAge;						/*!< Age of differential corrections, Blank (Null) fields when DGPS is not used */
+	NEO6M_Real_t hdop;						/*!< HDOP, Horizontal Dilution of Precision */
+	NEO6M_Real_t vdop;						/*!< VDOP, Vertical Dilution of Precision */
+	NEO6M_Real_t tdop;						/*!< TDOP, Time Dilution of Precision */
+	uint8_t numSvs;							/*!< Number of satellites used in the navigation solution */
+	uint16_t cs;							/*!< Checksum */
+}PUBX00_Package_t;
+
+
+/*
+ * Satellite status
+ */
+typedef struct
+{
+	uint8_t sv;								/*!< Satellite ID */
+	char status;							/*!< Status, U=Used in solution, e=Ephemeris available but not used, -=Not used */
+	uint16_t az;							/*!< Azimuth, range 0..359 */
+	uint8_t elv;							/*!< Elevation, range 0..90 */
+	uint8_t cno;							/*!< C/N0, range 0..99 */
+	uint8_t lck;							/*!< Satellite carrier lock time, s, range 0..64 */
+}PUBX_SV_Info_t;
+
+
+/*
+ * Satellite Status
+ */
+typedef struct
+{
+	char talker[3];							/*!< Always "PU" */
+	uint8_t n;								/*!< Number of GPS satellites tracked */
+	PUBX_SV_Info_t repeated_block[NEO6M_PUBX_MAX_SV];	/*!< Repeated block (n times, up to NEO6M_PUBX_MAX_SV) */
+	uint16_t cs;							/*!< Checksum */
+}PUBX03_Package_t;
+
+
+/*
+ * Time of Day and Clock Information
+ */
+typedef struct
+{
+	char talker[3];							/*!< Always "PU" */
+	uint32_t time;							/*!< UTC Time, Current time */
+	uint32_t timeMs;						/*!< UTC Time, milliseconds since midnight */
+	uint32_t date;							/*!< UTC Date, ddmmyy */
+	int64_t epoch;							/*!< Date and time as Unix time (ms), 0 if date is empty */
+	NEO6M_Real_t utcTow;					/*!< UTC Time of Week, s */
+	uint16_t utcWk;							/*!< UTC week number, continues beyond 1023 */
+	uint8_t leapSec;						/*!< Leap seconds */
+	int32_t clkBias;						/*!< Receiver clock bias, ns */
+	NEO6M_Real_t clkDrift;					/*!< Receiver clock drift, ns/s */
+	uint32_t tpGran;						/*!< Time pulse granularity, ns */
+	uint16_t cs;							/*!< Checksum */
+}PUBX04_Package_t;
+
+
+/*********************************************************************************************
+ *								  UBX protocol messages
+ * Packages are UBX payloads as is: little-endian fields at their natural alignment
+ ********************************************************************************************/
+
+/*
+ * Geodetic Position Solution
+ */
+typedef struct
+{
+	uint32_t iTOW;							/*!< GPS Millisecond Time of Week, ms */
+	int32_t lon;							/*!< Longitude, 1e-7 degrees */
+	int32_t lat;							/*!< Latitude, 1e-7 degrees */
+	int32_t height;							/*!< Height above Ellipsoid, mm */
+	int32_t hMSL;							/*!< Height above mean sea level, mm */
+	uint32_t hAcc;							/*!< Horizontal Accuracy Estimate, mm */
+	uint32_t vAcc;							/*!< Vertical Accuracy Estimate, mm */
+}NAV_POSLLH_Package_t;
+
+
+/*
+ * Velocity Solution in NED
+ */
+typedef struct
+{
+	uint32_t iTOW;							/*!< GPS Millisecond Time of Week, ms */
+	int32_t velN;							/*!< NED north velocity, cm/s */
+	int32_t velE;							/*!< NED east velocity, cm/s */
+	int32_t velD;							/*!< NED down velocity, cm/s */
+	uint32_t speed;							/*!< Speed (3-D), cm/s */
+	uint32_t gSpeed;						/*!< Ground Speed (2-D), cm/s */
+	int32_t heading;						/*!< Heading of motion 2-D, 1e-5 degrees */
+	uint32_t sAcc;							/*!< Speed Accuracy Estimate, cm/s */
+	uint32_t cAcc;							/*!< Course / Heading Accuracy Estimate, 1e-5 degrees */
+}NAV_VELNED_Package_t;
+
+
+/*
+ * Navigation Solution Information
+ */
+typedef struct
+{
+	uint32_t iTOW;							/*!< GPS Millisecond Time of Week, ms */
+	int32_t fTOW;							/*!< Fractional Nanoseconds remainder of rounded ms above, ns */
+	int16_t week;							/*!< GPS week (GPS time) */
+	uint8_t gpsFix;							/*!< GPSfix Type, 0=No fix, 2=2D fix, 3=3D fix */
+	uint8_t flags;							/*!< Fix Status Flags, bit 0 - GPSfixOK */
+	int32_t ecefX;							/*!< ECEF X coordinate, cm */
+	int32_t ecefY;							/*!< ECEF Y coordinate, cm */
+	int32_t ecefZ;							/*!< ECEF Z coordinate, cm */
+	uint32_t pAcc;							/*!< 3D Position Accuracy Estimate, cm */
+	int32_t ecefVX;							/*!< ECEF X velocity, cm/s */
+	int32_t ecefVY;							/*!< ECEF Y velocity, cm/s */
+	int32_t ecefVZ;							/*!< ECEF Z velocity, cm/s */
+	uint32_t sAcc;							/*!< Speed Accuracy Estimate, cm/s */
+	uint16_t pDOP;							/*!< Position DOP, 0.01 */
+	uint8_t reserved1;						/*!< Reserved */
+	uint8_t numSV;							/*!< Number of SVs used in Nav Solution */
+	uint32_t reserved2;						/*!< Reserved */
+}NAV_SOL_Package_t;
+
+
+/*
+ * UTC Time Solution
+ */
+typedef struct
+{
+	uint32_t iTOW;							/*!< GPS Millisecond Time of Week, ms */
+	uint32_t tAcc;							/*!< Time Accuracy Estimate, ns */
+	int32_t nano;							/*!< Nanoseconds of second, range -1e9..1e9 (UTC) */
+	uint16_t year;							/*!< Year, range 1999..2099 (UTC) */
+	uint8_t month;							/*!< Month, range 1..12 (UTC) */
+	uint8_t day;							/*!< Day of Month, range 1..31 (UTC) */
+	uint8_t hour;							/*!< Hour of Day, range 0..23 (UTC) */
+	uint8_t min;							/*!< Minute of Hour, range 0..59 (UTC) */
+	uint8_t sec;							/*!< Seconds of Minute, range 0..59 (UTC) */
+	uint8_t valid;							/*!< Validity Flags, bit 0 - validTOW, bit 1 - validWKN, bit 2 - validUTC */
+}NAV_TIMEUTC_Package_t;
+
+
+/*
+ * Dilution of precision
+ */
+typedef struct
+{
+	uint32_t iTOW;							/*!< GPS Millisecond Time of Week, ms */
+	uint16_t gDOP;							/*!< Geometric DOP, 0.01 */
+	uint16_t pDOP;							/*!< Position DOP, 0.01 */
+	uint16_t tDOP;							/*!< Time DOP, 0.01 */
+	uint16_t vDOP;							/*!< Vertical DOP, 0.01 */
+	uint16_t hDOP;							/*!< Horizontal DOP, 0.01 */
+	uint16_t nDOP;							/*!< Northing DOP, 0.01 */
+	uint16_t eDOP;							/*!< Easting DOP, 0.01 */
+}NAV_DOP_Package_t;
+
+
+/*
+ * Initial position and time (position is kept only, when it's injected)
+ */
+typedef struct
+{
+	int32_t ecefXOrLat;						/*!< ECEF X coordinate, cm, or latitude, 1e-7 degrees */
+	int32_t ecefYOrLon;						/*!< ECEF Y coordinate, cm, or longitude, 1e-7 degrees */
+	int32_t ecefZOrAlt;						/*!< ECEF Z coordinate, cm, or altitude, cm */
+	uint32_t posAcc;						/*!< Position accuracy (stddev), cm */
+	uint16_t tmCfg;							/*!< Time mark configuration */
+	uint16_t wnoOrDate;						/*!< Actual week number or yearSince2000/Month */
+	uint32_t towOrTime;						/*!< Actual time of week, ms, or DayOfMonth/H/MM/SS */
+	int32_t towNs;							/*!< Fractional part of time of week, ns */
+	uint32_t tAccMs;						/*!< Milliseconds part of time accuracy */
+	uint32_t tAccNs;						/*!< Nanoseconds part of time accuracy */
+	int32_t clkDOrFreq;						/*!< Clock drift, ns/s, or frequency, Hz * 1e-2 */
+	uint32_t clkDAcc;						/*!< Accuracy of clock drift, ns/s, or frequency, ppb */
+	uint32_t flags;							/*!< Bitmask with flags, see UBX_AID_INI_xxx */
+}AID_INI_Package_t;
+
+
+/*
+ * GPS Aiding Almanach Data, week is 0 if the satellite has no almanac (payload is only svid and week)
+ */
+typedef struct
+{
+	uint32_t svid;							/*!< SV ID, range 1..32 */
+	uint32_t week;							/*!< Issue Date of Almanach, GPS week number */
+	uint32_t dwrd[8];						/*!< Almanach Words */
+}AID_ALM_Package_t;
+
+
+/*
+ * GPS Aiding Ephemeris Data, how is 0 if the satellite has no ephemeris (payload is only svid and how)
+ */
+typedef struct
+{
+	uint32_t svid;							/*!< SV ID, range 1..32 */
+	uint32_t how;							/*!< Hand-Over Word of first Subframe */
+	uint32_t sf1d[8];						/*!< Subframe 1 Words 3..10 */
+	uint32_t sf2d[8];						/*!< Subframe 2 Words 3..10 */
+	uint32_t sf3d[8];						/*!< Subframe 3 Words 3..10 */
+}AID_EPH_Package_t;
+
+
 /*********************************************************************************************
  *									Function declarations 
  ********************************************************************************************/
@@ -227,9 +762,42 @@ typedef struct
 /*
  * Supported user functions
  */
+uint8_t NEO6M_Init(NEO6M_Handle_t *handle, UART_HandleTypeDef *huart);
 void NEO6M_MessageHandler(NEO6M_Handle_t *handle);
+void NEO6M_Process(NEO6M_Handle_t *handle);
+void NEO6M_RxEventHandler(NEO6M_Handle_t *handle, uint16_t size);
+void NEO6M_ErrorHandler(NEO6M_Handle_t *handle);
+void NEO6M_IRQHandler(NEO6M_Handle_t *handle);
+
+/*
+ * Dispatchers of UART callbacks to the handle of appropriate receiver
+ */
+void NEO6M_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void NEO6M_UART_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size);
+void NEO6M_UART_ErrorCallback(UART_HandleTypeDef *huart);
+void NEO6M_UART_IRQHandler(UART_HandleTypeDef *huart);
 uint8_t NEO6M_AddExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
 uint8_t NEO6M_RemoveExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+uint8_t NEO6M_SetBaudRate(NEO6M_Handle_t *handle, uint32_t baudrate);
+uint8_t NEO6M_SetModuleFiltering(NEO6M_Handle_t *handle, uint8_t enable);
+uint8_t NEO6M_SetNavigationRate(NEO6M_Handle_t *handle, uint16_t meas_rate);
+uint32_t NEO6M_GetUARTLoad(NEO6M_Handle_t *handle, uint16_t meas_rate);
+void NEO6M_SetTalkers(NEO6M_Handle_t *handle, uint8_t talkers);
+uint8_t NEO6M_AddExpectedSentence(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+uint8_t NEO6M_RemoveExpectedSentence(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+uint8_t NEO6M_SetTracking(NEO6M_Handle_t *handle, uint8_t trackers);
+uint8_t NEO6M_PollMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+uint8_t NEO6M_RestoreAiding(NEO6M_Handle_t *handle);
+
+/*
+ * Accessors of the fields of the sentence, field 0 is the first field after address
+ */
+uint8_t NEO6M_GetFieldsCount(const NEO6M_Sentence_t *sentence);
+char NEO6M_GetChar(NEO6M_Sentence_t *sentence, uint8_t field);
+int32_t NEO6M_GetInt(NEO6M_Sentence_t *sentence, uint8_t field);
+uint32_t NEO6M_GetTime(NEO6M_Sentence_t *sentence, uint8_t field);
+NEO6M_Real_t NEO6M_GetReal(NEO6M_Sentence_t *sentence, uint8_t field);
+NEO6M_Coord_t NEO6M_GetCoord(NEO6M_Sentence_t *sentence, uint8_t field);
 
 /*
  * Supported callback functions
@@ -240,5 +808,24 @@ void NEO6M_GSACallBack(void *package);
 void NEO6M_GSVCallBack(void *package);
 void NEO6M_RMCCallBack(void *package);
 void NEO6M_VTGCallBack(void *package);
+void NEO6M_DTMCallBack(void *package);
+void NEO6M_GBSCallBack(void *package);
+void NEO6M_PUBX00CallBack(void *package);
+void NEO6M_PUBX03CallBack(void *package);
+void NEO6M_PUBX04CallBack(void *package);
+void NEO6M_NAV_POSLLHCallBack(void *package);
+void NEO6M_NAV_VELNEDCallBack(void *package);
+void NEO6M_NAV_SOLCallBack(void *package);
+void NEO6M_NAV_TIMEUTCCallBack(void *package);
+void NEO6M_NAV_DOPCallBack(void *package);
+void NEO6M_AID_INICallBack(void *package);
+void NEO6M_AID_ALMCallBack(void *package);
+void NEO6M_AID_EPHCallBack(void *package);
+void NEO6M_SentenceCallBack(NEO6M_Sentence_t *sentence);
+void NEO6M_SkyCallBack(const NEO6M_Sky_t *sky);
+void NEO6M_NavSolutionCallBack(const NEO6M_NavSolution_t *solution);
+uint8_t NEO6M_AidingBeginCallBack(void);
+uint8_t NEO6M_AidingWriteCallBack(uint32_t offset, const uint8_t *data, uint16_t length);
+uint8_t NEO6M_AidingReadCallBack(uint32_t offset, uint8_t *data, uint16_t length);
 
 #endif /* INC_NEO_6M_H_ */
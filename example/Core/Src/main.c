@@ -47,8 +47,6 @@ UART_HandleTypeDef huart2;
 
 NEO6M_Handle_t neo6mh;
 
-UART_HandleTypeDef *gps_uart = &huart1;
-
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -96,17 +94,25 @@ int main(void)
   MX_USART1_UART_Init();
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
+  NEO6M_Init(&neo6mh, &huart1);
 
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
+  uint32_t last_request = HAL_GetTick();
+  NEO6M_AddExpectedMessage(&neo6mh, RMC);
+
   while (1)
   {
     /* USER CODE END WHILE */
-	  NEO6M_AddExpectedMessage(&neo6mh, RMC);
+	  if(HAL_GetTick() - last_request >= 5000)
+	  {
+		  last_request = HAL_GetTick();
+		  NEO6M_AddExpectedMessage(&neo6mh, RMC);
+	  }
 
-	  HAL_Delay(5000);
+	  NEO6M_Process(&neo6mh);
 
 
     /* USER CODE BEGIN 3 */
@@ -242,7 +248,12 @@ static void MX_GPIO_Init(void)
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
-	NEO6M_MessageHandler(&neo6mh);
+	NEO6M_UART_RxCpltCallback(huart);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	NEO6M_UART_ErrorCallback(huart);
 }
 
 void NEO6M_RMCCallBack(void *package)
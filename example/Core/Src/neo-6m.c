@@ -8,17 +8,166 @@
 #include "neo-6m.h"
 
 
-static double nmea_to_dec(double deg_coord, char nsew);
+/*
+ * Formats of package fields
+ */
+typedef enum
+{
+	FIELD_CHAR,								/* char, 0 for empty field */
+	FIELD_U8,								/* uint8_t */
+	FIELD_U16,								/* uint16_t */
+	FIELD_U32,								/* uint32_t */
+	FIELD_I32,								/* int32_t, could be negative */
+	FIELD_REAL,								/* NEO6M_Real_t */
+	FIELD_TIME,								/* uint32_t, hhmmss.ss decoded to milliseconds since midnight */
+	FIELD_COORD,							/* NEO6M_Coord_t, field must be followed by N/S or E/W field */
+	FIELD_STRING							/* char[], truncated to the size of the member and null terminated */
+}FieldFormat_t;
+
+
+/*
+ * Field of the sentence, that is decoded to the member of the package
+ */
+typedef struct
+{
+	uint8_t index;							/* Index of the field in the sentence, 0 - first field after address */
+	uint8_t format;							/* Format of the member, see FieldFormat_t */
+	uint16_t offset;						/* Offset of the member in the package */
+	uint8_t size;							/* Size of the member in the package */
+}FieldDescriptor_t;
+
+
+/*
+ * Package of the message, that the sentence is decoded to
+ */
+typedef struct
+{
+	const FieldDescriptor_t *fields;		/* Decoded fields */
+	uint8_t fieldsCount;					/* Count of decoded fields */
+	uint8_t csOffset;						/* Offset of the checksum in the package */
+	uint8_t talkerOffset;					/* Offset of the talker in the package */
+	void (*finish)(void *package);			/* Computes members derived from decoded ones, could be NULL */
+}PackageDescriptor_t;
+
+
+/*
+ * Any package of NMEA standard messages
+ */
+typedef union
+{
+	GLL_Package_t gll;
+	GGA_Package_t gga;
+	GSA_Package_t gsa;
+	GSV_Package_t gsv;
+	RMC_Package_t rmc;
+	VTG_Package_t vtg;
+	DTM_Package_t dtm;
+	GBS_Package_t gbs;
+	PUBX00_Package_t pubx00;
+	PUBX03_Package_t pubx03;
+	PUBX04_Package_t pubx04;
+	NAV_POSLLH_Package_t navPosllh;
+	NAV_VELNED_Package_t navVelned;
+	NAV_SOL_Package_t navSol;
+	NAV_TIMEUTC_Package_t navTimeutc;
+	NAV_DOP_Package_t navDop;
+	AID_INI_Package_t aidIni;
+	AID_ALM_Package_t aidAlm;
+	AID_EPH_Package_t aidEph;
+}NMEA_Package_t;
+
+
+/*
+ * The last supported message type, the first UBX message type, messages, that the module outputs by default,
+ * and messages, that are output only when polled (they aren't configured with UBX-CFG-MSG)
+ */
+#define LAST_MESSAGE_TYPE	AID_EPH
+#define FIRST_UBX_TYPE		NAV_POSLLH
+#define DEFAULT_MESSAGES	((1UL << GLL) | (1UL << GGA) | (1UL << GSA) | (1UL << GSV) | (1UL << RMC) | (1UL << VTG))
+#define POLLED_MESSAGES		((1UL << PUBX00) | (1UL << PUBX03) | (1UL << PUBX04) | AIDING_MESSAGES)
+
+
+/*
+ * Messages, that aiding data is saved and injected with, and length of their payload, if satellite has no data
+ */
+#define AIDING_MESSAGES		((1UL << AID_INI) | (1UL << AID_ALM) | (1UL << AID_EPH))
+#define AID_EMPTY_LENGTH	8
+
+
+/*
+ * Saved aiding data: header (length of frames, checksum of frames and 2 reserved bytes), then UBX frames of
+ * AID-INI, AID-ALM and AID-EPH of all satellites at most
+ */
+#define AIDING_HEADER_LENGTH	8
+#define AIDING_MAX_LENGTH		(8 + sizeof(AID_INI_Package_t) + \
+								 NEO6M_AIDING_MAX_SV * (16 + sizeof(AID_ALM_Package_t) + sizeof(AID_EPH_Package_t)))
 
-static void gga_handle(NEO6M_Handle_t *handle, uint32_t message_num);
-static void gll_handle(NEO6M_Handle_t *handle, uint32_t message_num);
-static void gsa_handle(NEO6M_Handle_t *handle, uint32_t message_num);
-static void gsv_handle(NEO6M_Handle_t *handle, uint32_t message_num);
-static void rmc_handle(NEO6M_Handle_t *handle, uint32_t message_num);
-static void vtg_handle(NEO6M_Handle_t *handle, uint32_t message_num);
+#define UBX_MESSAGE(class, id)	(((class) << 8) | (id))
 
-static void nmea_parser(char *package, char *formats, ...);
-static uint8_t gsv_get_noMsg(char *buff);
+
+/*
+ * Messages, that complete navigation solution of the epoch
+ */
+#define EPOCH_MESSAGES		((1UL << RMC) | (1UL << VTG) | (1UL << GGA) | (1UL << GSA))
+
+
+#define NMEA_FIELD(index, format, package, member)	{(index), (format), offsetof(package, member), \
+													 sizeof(((package *)0)->member)}
+#define NMEA_PACKAGE(package, fields, finish)		{(fields), sizeof(fields) / sizeof((fields)[0]), \
+													 offsetof(package, cs), offsetof(package, talker), (finish)}
+
+
+static void nmea_decode(const NEO6M_SentenceView_t *sentence, const PackageDescriptor_t *descriptor, void *package);
+static char view_char(const NEO6M_SentenceView_t *view, uint16_t position);
+static int32_t view_to_int(const NEO6M_SentenceView_t *view, uint16_t position, uint8_t base);
+static int32_t view_to_fixed(const NEO6M_SentenceView_t *view, uint16_t position, uint8_t decimals);
+static NEO6M_Coord_t view_to_coord(const NEO6M_SentenceView_t *view, uint16_t position, char nsew);
+static int32_t coord_to_fixed(const NEO6M_SentenceView_t *view, uint16_t position, char nsew);
+static uint32_t view_to_time(const NEO6M_SentenceView_t *view, uint16_t position);
+static int64_t nmea_to_epoch(uint32_t date, uint32_t time_ms);
+static void rmc_finish(void *package);
+static void pubx04_finish(void *package);
+static uint16_t view_next_field(const NEO6M_SentenceView_t *view, uint16_t position);
+static uint16_t view_field(const NEO6M_SentenceView_t *view, uint8_t field);
+static int32_t sentence_value(NEO6M_Sentence_t *sentence, uint8_t field, FieldFormat_t kind);
+static uint32_t uart_index(UART_HandleTypeDef *huart);
+
+static uint8_t start_receive(NEO6M_Handle_t *handle);
+static void stop_receive(NEO6M_Handle_t *handle);
+static void receive_byte(NEO6M_Handle_t *handle, char byte);
+static void dispatch_sentence(NEO6M_Handle_t *handle, const NEO6M_SentenceView_t *sentence, const NEO6M_SentenceSlot_t *slot);
+static uint8_t process_sentence(NEO6M_Handle_t *handle);
+static uint8_t is_intact(NEO6M_Handle_t *handle, const NEO6M_SentenceSlot_t *slot);
+static uint8_t wait_valid_sentence(NEO6M_Handle_t *handle, uint32_t timeout, uint32_t since);
+static uint8_t switch_baudrate(NEO6M_Handle_t *handle, uint32_t baudrate);
+
+static uint8_t ubx_send(NEO6M_Handle_t *handle, uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t length);
+static uint8_t ubx_send_port(NEO6M_Handle_t *handle, uint32_t baudrate);
+static uint8_t ubx_send_config(NEO6M_Handle_t *handle, uint8_t msg_id, const uint8_t *payload, uint16_t length);
+static uint8_t ubx_receive_byte(NEO6M_Handle_t *handle, uint8_t byte);
+static void ubx_decode(const NEO6M_SentenceView_t *frame, MessagesTypes_t message_type, void *package);
+static MessagesTypes_t ubx_type(uint16_t message, uint16_t length);
+static void queue_publish(NEO6M_Handle_t *handler, uint16_t length);
+static void ubx_checksum(const uint8_t *data, uint16_t length, uint8_t *checksum);
+static uint8_t set_message_rate(NEO6M_Handle_t *handle, MessagesTypes_t message_type, uint8_t rate);
+static uint8_t is_expected(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+static uint8_t is_output(NEO6M_Handle_t *handle, MessagesTypes_t message_type);
+static uint8_t subscribe(NEO6M_Handle_t *handle, uint32_t *subscriptions, MessagesTypes_t message_type);
+static uint8_t unsubscribe(NEO6M_Handle_t *handle, uint32_t *subscriptions, MessagesTypes_t message_type);
+static uint8_t set_subscriptions(NEO6M_Handle_t *handle, uint32_t *subscriptions, uint32_t value);
+static uint32_t expected_messages(NEO6M_Handle_t *handle);
+static void track_message(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NEO6M_SentenceView_t *sentence, const NMEA_Package_t *package);
+static void aiding_poll(NEO6M_Handle_t *handle);
+static void aiding_save(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NMEA_Package_t *package);
+static void aiding_finish(NEO6M_Handle_t *handle);
+static uint16_t aiding_read_frame(uint32_t offset, uint32_t end, uint8_t *frame);
+static void sky_update(NEO6M_Handle_t *handle, const GSV_Package_t *gsv);
+static void sky_used(NEO6M_Handle_t *handle, const GSA_Package_t *gsa);
+static void epoch_merge(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NMEA_Package_t *package, uint8_t time_known);
+static void epoch_deliver(NEO6M_Handle_t *handle);
+static MessagesTypes_t message_type(uint32_t address);
+static MessagesTypes_t pubx_type(char id1, char id2);
+static Talker_t message_talker(uint32_t address);
 
 
 static const NMEA_StandardMessage_t NMEA_STANDART_MESSAGGES[] =
@@ -29,451 +178,2898 @@ static const NMEA_StandardMessage_t NMEA_STANDART_MESSAGGES[] =
 		{GSA, "$GPGSA", &NEO6M_GSACallBack},
 		{GSV, "$GPGSV", &NEO6M_GSVCallBack},
 		{RMC, "$GPRMC", &NEO6M_RMCCallBack},
-		{VTG, "$GPVTG", &NEO6M_VTGCallBack}
+		{VTG, "$GPVTG", &NEO6M_VTGCallBack},
+		{DTM, "$GPDTM", &NEO6M_DTMCallBack},
+		{GBS, "$GPGBS", &NEO6M_GBSCallBack},
+		{PUBX00, "$PUBX,00", &NEO6M_PUBX00CallBack},
+		{PUBX03, "$PUBX,03", &NEO6M_PUBX03CallBack},
+		{PUBX04, "$PUBX,04", &NEO6M_PUBX04CallBack},
+		{NAV_POSLLH, {0}, &NEO6M_NAV_POSLLHCallBack},
+		{NAV_VELNED, {0}, &NEO6M_NAV_VELNEDCallBack},
+		{NAV_SOL, {0}, &NEO6M_NAV_SOLCallBack},
+		{NAV_TIMEUTC, {0}, &NEO6M_NAV_TIMEUTCCallBack},
+		{NAV_DOP, {0}, &NEO6M_NAV_DOPCallBack},
+		{AID_INI, {0}, &NEO6M_AID_INICallBack},
+		{AID_ALM, {0}, &NEO6M_AID_ALMCallBack},
+		{AID_EPH, {0}, &NEO6M_AID_EPHCallBack}
+};
+
+
+/*
+ * Classes and IDs of messages in UBX protocol, indexed by message type
+ */
+static const uint16_t MESSAGE_UBX_IDS[] =
+{
+		0xFFFF,											/* EMPTY */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x01),				/* GLL */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x00),				/* GGA */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x02),				/* GSA */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x03),				/* GSV */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x04),				/* RMC */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x05),				/* VTG */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x0A),				/* DTM */
+		UBX_MESSAGE(UBX_CLASS_NMEA, 0x09),				/* GBS */
+		UBX_MESSAGE(UBX_CLASS_PUBX, 0x00),				/* PUBX00 */
+		UBX_MESSAGE(UBX_CLASS_PUBX, 0x03),				/* PUBX03 */
+		UBX_MESSAGE(UBX_CLASS_PUBX, 0x04),				/* PUBX04 */
+		UBX_MESSAGE(UBX_CLASS_NAV, UBX_NAV_POSLLH),		/* NAV_POSLLH */
+		UBX_MESSAGE(UBX_CLASS_NAV, UBX_NAV_VELNED),		/* NAV_VELNED */
+		UBX_MESSAGE(UBX_CLASS_NAV, UBX_NAV_SOL),		/* NAV_SOL */
+		UBX_MESSAGE(UBX_CLASS_NAV, UBX_NAV_TIMEUTC),	/* NAV_TIMEUTC */
+		UBX_MESSAGE(UBX_CLASS_NAV, UBX_NAV_DOP),		/* NAV_DOP */
+		UBX_MESSAGE(UBX_CLASS_AID, UBX_AID_INI),		/* AID_INI */
+		UBX_MESSAGE(UBX_CLASS_AID, UBX_AID_ALM),		/* AID_ALM */
+		UBX_MESSAGE(UBX_CLASS_AID, UBX_AID_EPH)			/* AID_EPH */
+};
+
+
+/*
+ * Payload lengths of UBX messages, indexed by message type - FIRST_UBX_TYPE
+ */
+static const uint8_t UBX_PAYLOAD_LENGTHS[] =
+{
+		28,			/* NAV_POSLLH */
+		36,			/* NAV_VELNED */
+		52,			/* NAV_SOL */
+		20,			/* NAV_TIMEUTC */
+		18,			/* NAV_DOP */
+		48,			/* AID_INI */
+		40,			/* AID_ALM */
+		104			/* AID_EPH */
+};
+
+
+/*
+ * Packed formatters of NMEA standard messages, indexed by message type, talker isn't included
+ */
+#define NMEA_FORMATTER(f1, f2, f3)			NMEA_ADDRESS_PACK(NMEA_ADDRESS_PACK(NMEA_ADDRESS_PACK(0, f1), f2), f3)
+#define NMEA_TALKER(t1, t2)					NMEA_ADDRESS_PACK(NMEA_ADDRESS_PACK(0, t1), t2)
+
+static const uint32_t NMEA_FORMATTERS[] =
+{
+		0,									/* EMPTY */
+		NMEA_FORMATTER('G', 'L', 'L'),
+		NMEA_FORMATTER('G', 'G', 'A'),
+		NMEA_FORMATTER('G', 'S', 'A'),
+		NMEA_FORMATTER('G', 'S', 'V'),
+		NMEA_FORMATTER('R', 'M', 'C'),
+		NMEA_FORMATTER('V', 'T', 'G'),
+		NMEA_FORMATTER('D', 'T', 'M'),
+		NMEA_FORMATTER('G', 'B', 'S')
+};
+
+
+/*
+ * Types of NMEA standard messages, indexed by perfect hash of the formatter.
+ * Hash is collision free for all NEO-6M formatters: DTM, GBS, GGA, GLL, GRS, GSA, GST, GSV, RMC, TXT, VTG, ZDA
+ */
+#define NMEA_FORMATTER_HASH(formatter)		((((formatter) >> 8) ^ ((formatter) >> 1)) & 0x1F)
+
+static const MessagesTypes_t NMEA_FORMATTER_TYPES[32] =
+{
+		[21] = GLL,
+		[17] = GGA,
+		[20] = GSA,
+		[31] = GSV,
+		[2] = RMC,
+		[6] = VTG,
+		[3] = DTM,
+		[25] = GBS
 };
 
 
-typedef void (*HandlerFunction_t)(NEO6M_Handle_t*, uint32_t);
+/*
+ * Packed address of u-blox proprietary sentences, the message ID follows it as the first field
+ */
+#define PUBX_ADDRESS						NMEA_ADDRESS_PACK(NMEA_FORMATTER('P', 'U', 'B'), 'X')
+#define PUBX_ID_END							9		/* Length of "$PUBX,00," */
+
+
+/*
+ * Maximum count of bytes, that messages take per epoch, indexed by message type
+ */
+static const uint16_t NMEA_EPOCH_BYTES[] =
+{
+		0,			/* EMPTY */
+		52,			/* GLL */
+		82,			/* GGA */
+		68,			/* GSA */
+		4 * 72,		/* GSV, up to 4 parts for 16 satellites in view */
+		72,			/* RMC */
+		42,			/* VTG */
+		47,			/* DTM */
+		60,			/* GBS */
+		112,		/* PUBX00 */
+		14 + 12 * 21,	/* PUBX03, for 12 tracked satellites */
+		76,			/* PUBX04 */
+		8 + 28,		/* NAV_POSLLH, header, payload and checksum */
+		8 + 36,		/* NAV_VELNED */
+		8 + 52,		/* NAV_SOL */
+		8 + 20,		/* NAV_TIMEUTC */
+		8 + 18,		/* NAV_DOP */
+		0,			/* AID_INI, polled once per NEO6M_AIDING_PERIOD, not each epoch */
+		0,			/* AID_ALM */
+		0			/* AID_EPH */
+};
+
 
-static const HandlerFunction_t NMEA_MESSAGGES_HANDLERS[] =
+/*
+ * States of UBX frame receiving
+ */
+enum
 {
-		&gll_handle,
-		&gga_handle,
-		&gsa_handle,
-		&gsv_handle,
-		&rmc_handle,
-		&vtg_handle
+	UBX_STATE_IDLE,
+	UBX_STATE_SYNC,
+	UBX_STATE_HEADER,
+	UBX_STATE_PAYLOAD,
+	UBX_STATE_CHECKSUM
 };
 
 
-/*********************************************************************************************
- *								Supported user functions
- ********************************************************************************************/
+/*
+ * Handles of initialized receivers, indexed by UART instance
+ */
+static NEO6M_Handle_t *neo6m_handles[NEO6M_UART_COUNT];
+
+
+/*********************************************************************************************
+ *								Supported user functions
+ ********************************************************************************************/
+
+/**
+  * @brief   This function initializes the handle, and binds it to the UART used with the module
+  * @note	 Each receiver must use its own handle and UART.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *huart: Pointer to the UART handle used with the module
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_Init(NEO6M_Handle_t *handle, UART_HandleTypeDef *huart)
+{
+	if(huart == NULL)
+	{
+		return 1;
+	}
+
+	memset(handle, 0, sizeof(NEO6M_Handle_t));
+	handle->huart = huart;
+	handle->talkers = NEO_TALKER_ALL;
+	handle->navLastTime = UINT32_MAX;
+	neo6m_handles[uart_index(huart)] = handle;
+
+	return 0;
+}
+
+
+/**
+  * @brief   This function adds the type of NMEA message to list that determine which callbacks user need
+  * @note	 Adding the message, that is already expected, has no effect.
+  * 		 If module filtering is enabled, the message is also enabled in the module
+  * @param   *handler: Pointer to the handler structure.
+  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_AddExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	return subscribe(handle, &handle->subscriptions, message_type);
+}
+
+
+/**
+  * @brief   This function remove the type of NMEA message from the list that determine which callbacks user need
+  * @note	 If module filtering is enabled and the message isn't expected anymore, it's disabled in the module
+  * @param   *handler: Pointer to the handler structure.
+  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_RemoveExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	return unsubscribe(handle, &handle->subscriptions, message_type);
+}
+
+
+/**
+  * @brief   This function adds the type of NMEA message, that is delivered to NEO6M_SentenceCallBack
+  * 		 as not decoded sentence. Its fields are decoded only when they are read by accessors.
+  * @note	 Message could be expected both as sentence and as package, then both callbacks are called
+  * @param   *handler: Pointer to the handler structure.
+  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_AddExpectedSentence(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	//UBX messages have no fields to access
+	if(message_type >= FIRST_UBX_TYPE)
+	{
+		return 1;
+	}
+
+	return subscribe(handle, &handle->sentenceSubscriptions, message_type);
+}
+
+
+/**
+  * @brief   This function removes the type of NMEA message, that is delivered to NEO6M_SentenceCallBack
+  * @param   *handler: Pointer to the handler structure.
+  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_RemoveExpectedSentence(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	return unsubscribe(handle, &handle->sentenceSubscriptions, message_type);
+}
+
+
+/**
+  * @brief   This function enables trackers, that keep data assembled from received messages in the handle
+  * @note	 Messages needed by trackers are received, even if they aren't expected by user
+  * @param   *handler: Pointer to the handler structure.
+  * @param   trackers: Combination of trackers, see @trackers, 0 - disables all trackers
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_SetTracking(NEO6M_Handle_t *handle, uint8_t trackers)
+{
+	uint32_t messages = 0;
+
+	if(trackers & NEO_TRACK_SKY)
+	{
+		messages |= (1UL << GSV) | (1UL << GSA);
+	}
+
+	if(trackers & NEO_TRACK_EPOCH)
+	{
+		messages |= EPOCH_MESSAGES;
+	}
+	else
+	{
+		//Drops the epoch being merged
+		memset(&handle->navSolution, 0, sizeof(NEO6M_NavSolution_t));
+		handle->navLastTime = UINT32_MAX;
+		handle->navLate = 0;
+	}
+
+	//Aiding data is polled after the period, when the module has it
+	if(trackers & NEO_TRACK_AIDING)
+	{
+		messages |= AIDING_MESSAGES;
+		if(!(handle->trackers & NEO_TRACK_AIDING))
+		{
+			handle->aidingPolled = HAL_GetTick();
+		}
+	}
+	else if(handle->aidingSaving)
+	{
+		//Storage was already prepared for the data being saved, so what is received is kept
+		aiding_finish(handle);
+	}
+
+	handle->trackers = trackers;
+	return set_subscriptions(handle, &handle->trackingSubscriptions, messages);
+}
+
+
+/**
+  * @brief   This function requests the module to output the message once
+  * @note	 PUBX messages are polled by their address (e.g. $PUBX,00), NMEA standard messages are polled by
+  * 		 GPQ query (e.g. $EIGPQ,RMC), UBX messages are polled by the frame with empty payload.
+  * 		 Response is received as usual, if the message type is expected.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_PollMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	const char *formatter;
+	char sentence[20];
+	uint8_t checksum = 0;
+	int length;
+
+	if(message_type <= EMPTY || message_type > LAST_MESSAGE_TYPE)
+	{
+		return 1;
+	}
+	formatter = NMEA_STANDART_MESSAGGES[message_type].formatter;
+
+	if(message_type >= FIRST_UBX_TYPE)
+	{
+		return ubx_send(handle, MESSAGE_UBX_IDS[message_type] >> 8, (uint8_t)MESSAGE_UBX_IDS[message_type], NULL, 0);
+	}
+
+	if((POLLED_MESSAGES >> message_type) & 1)
+	{
+		length = snprintf(sentence, sizeof(sentence), "%s", formatter);
+	}
+	else
+	{
+		length = snprintf(sentence, sizeof(sentence), "$EIGPQ,%s", formatter + 3);
+	}
+
+	//Checksum is computed between '$' and '*'
+	for(int i = 1; i < length; i++)
+	{
+		checksum ^= sentence[i];
+	}
+	length += snprintf(sentence + length, sizeof(sentence) - length, "*%02X" END_SEQUENCE, checksum);
+
+	return (HAL_UART_Transmit(handle->huart, (uint8_t *)sentence, length, NEO6M_CONFIG_TIMEOUT) != HAL_OK);
+}
+
+
+/**
+  * @brief   This function injects aiding data, saved by NEO_TRACK_AIDING tracker, to the module
+  * @note	 Should be called at boot, before messages are expected, so the module gets the first fix faster.
+  * 		 Saved data is read with NEO6M_AidingReadCallBack, and it's injected only if its length and checksum
+  * 		 are valid. Saved time is outdated, so only position of AID-INI is injected, and the module validates
+  * 		 ephemeris and almanac by its own time.
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  0 - if successfully, otherwise - 1 (nothing is saved, saved data is broken or sending failed)
+  */
+uint8_t NEO6M_RestoreAiding(NEO6M_Handle_t *handle)
+{
+	uint8_t frame[8 + sizeof(AID_EPH_Package_t)];
+	uint8_t header[AIDING_HEADER_LENGTH];
+	uint8_t checksum[2] = {0};
+	uint32_t offset;
+	uint32_t end;
+	uint32_t flags;
+	uint16_t size;
+
+	if(NEO6M_AidingReadCallBack(0, header, sizeof(header)))
+	{
+		return 1;
+	}
+
+	end = AIDING_HEADER_LENGTH + (header[0] | (header[1] << 8) | ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24));
+	if(end == AIDING_HEADER_LENGTH || end > AIDING_HEADER_LENGTH + AIDING_MAX_LENGTH)
+	{
+		return 1;
+	}
+
+	//Whole data is verified before anything is injected
+	for(offset = AIDING_HEADER_LENGTH; offset < end; offset += size)
+	{
+		if(!(size = aiding_read_frame(offset, end, frame)))
+		{
+			return 1;
+		}
+		ubx_checksum(frame, size, checksum);
+	}
+	if(checksum[0] != header[4] || checksum[1] != header[5])
+	{
+		return 1;
+	}
+
+	for(offset = AIDING_HEADER_LENGTH; offset < end; offset += size)
+	{
+		if(!(size = aiding_read_frame(offset, end, frame)))
+		{
+			return 1;
+		}
+
+		if(frame[3] == UBX_AID_INI)
+		{
+			memcpy(&flags, frame + 6 + offsetof(AID_INI_Package_t, flags), sizeof(flags));
+			flags &= UBX_AID_INI_POS | UBX_AID_INI_LLA | UBX_AID_INI_ALT_INV;
+			memcpy(frame + 6 + offsetof(AID_INI_Package_t, flags), &flags, sizeof(flags));
+		}
+
+		if(ubx_send(handle, frame[2], frame[3], frame + 6, size - 8))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+  * @brief   This function switches the module and the UART to another baud rate
+  * @note	 UBX-CFG-PRT is sent to the module at the current baud rate, then the UART is reinitialized
+  * 		 and the switch is verified by waiting for a sentence with valid checksum. On failure the module
+  * 		 is switched back at the new baud rate, and then the UART is switched back. Should be called from the main loop or a task, not from an interrupt.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   baudrate: New baud rate, e.g. 38400 or 115200
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_SetBaudRate(NEO6M_Handle_t *handle, uint32_t baudrate)
+{
+	uint32_t old_baudrate = handle->huart->Init.BaudRate;
+
+	if(ubx_send_port(handle, baudrate))
+	{
+		return 1;
+	}
+
+	//Module applies new configuration after the acknowledge
+	HAL_Delay(100);
+
+	if(!switch_baudrate(handle, baudrate))
+	{
+		return 0;
+	}
+
+	//Falls back to the previous baud rate: module could switch without sending, so it's switched back too
+	ubx_send_port(handle, old_baudrate);
+	HAL_Delay(100);
+	switch_baudrate(handle, old_baudrate);
+	return 1;
+}
+
+
+/**
+  * @brief   This function enables or disables filtering of NMEA messages by the module
+  * @note	 When filtering is enabled, the module outputs only expected messages: UBX-CFG-MSG is sent
+  * 		 for each supported message now and whenever the message is added or removed, and the module
+  * 		 must acknowledge it. Module's TX and RX lines both must be connected.
+  * 		 When filtering is disabled, messages enabled by default (GLL, GGA, GSA, GSV, RMC, VTG) are enabled
+  * 		 in the module, other messages (DTM, GBS) are enabled only while they are expected.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   enable: 1 - enable filtering, 0 - disable filtering
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_SetModuleFiltering(NEO6M_Handle_t *handle, uint8_t enable)
+{
+	uint8_t flag=0;
+
+	handle->moduleFiltering = enable;
+
+	for(MessagesTypes_t type = GLL; type <= LAST_MESSAGE_TYPE; type++)
+	{
+		if(!((POLLED_MESSAGES >> type) & 1))
+		{
+			flag |= set_message_rate(handle, type, is_output(handle, type));
+		}
+	}
+
+	return flag;
+}
+
+
+/**
+  * @brief   This function sets navigation (measurement) rate of the module with UBX-CFG-RATE
+  * @note	 The rate is refused, if messages output by the module at this rate don't fit
+  * 		 NEO6M_MAX_UART_LOAD of the UART bandwidth, see NEO6M_GetUARTLoad
+  * @param   *handler: Pointer to the handler structure.
+  * @param   meas_rate: Measurement period (ms), 1000 - 1 Hz, 200 - 5 Hz
+  * @retval  0 - if successfully, otherwise - 1
+  */
+uint8_t NEO6M_SetNavigationRate(NEO6M_Handle_t *handle, uint16_t meas_rate)
+{
+	uint8_t payload[6] = {(uint8_t)meas_rate, (uint8_t)(meas_rate >> 8), 1, 0, 1, 0};	/* navRate - 1 cycle, timeRef - GPS */
+
+	if(meas_rate < NEO6M_MIN_MEAS_RATE || NEO6M_GetUARTLoad(handle, meas_rate) > NEO6M_MAX_UART_LOAD)
+	{
+		return 1;
+	}
+
+	if(ubx_send_config(handle, UBX_CFG_RATE, payload, sizeof(payload)))
+	{
+		return 1;
+	}
+
+	handle->measRate = meas_rate;
+	return 0;
+}
+
+
+/**
+  * @brief   This function estimates UART load by messages, that module outputs at the measurement rate
+  * @note	 Without module filtering, messages enabled by default are counted, since module outputs them anyway
+  * @param   *handler: Pointer to the handler structure.
+  * @param   meas_rate: Measurement period (ms)
+  * @retval  uint32_t UART load (%) in the worst case, may exceed 100
+  */
+uint32_t NEO6M_GetUARTLoad(NEO6M_Handle_t *handle, uint16_t meas_rate)
+{
+	uint32_t epoch_bytes = 0;
+
+	for(MessagesTypes_t type = GLL; type <= LAST_MESSAGE_TYPE; type++)
+	{
+		if(is_output(handle, type))
+		{
+			epoch_bytes += NMEA_EPOCH_BYTES[type];
+		}
+	}
+
+	if(meas_rate == 0)
+	{
+		return 0;
+	}
+
+	//Each byte takes 10 bits on the line (start, 8 data and stop bits)
+	return (epoch_bytes * 10 * 1000 * 100 / meas_rate) / handle->huart->Init.BaudRate;
+}
+
+
+/**
+  * @brief   This function selects talkers, that messages are accepted from
+  * @note	 Messages are recognized by formatter regardless of talker, so all talkers are accepted by default
+  * @param   *handler: Pointer to the handler structure.
+  * @param   talkers: Combination of talkers, see @talkers
+  * @retval  None
+  */
+void NEO6M_SetTalkers(NEO6M_Handle_t *handle, uint8_t talkers)
+{
+	handle->talkers = talkers;
+}
+
+
+/**
+  * @brief   This function receives messages from module byte by byte, and manages message if end sequence happened
+  * @note	 Ensure this is invoked within the appropriate UART callback for proper operation.
+  * 		 Used only with NEO6M_RECEIVE_IT receive mode, see @receive_modes in .h file
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+void NEO6M_MessageHandler(NEO6M_Handle_t *handler)
+{
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_IT
+	receive_byte(handler, handler->rcvdByte);
+
+	//Requests next byte only if receiving wasn't stopped (no messages are expected and module isn't configured)
+	if(handler->rxArmed)
+	{
+		HAL_UART_Receive_IT(handler->huart, (uint8_t *)&handler->rcvdByte, 1);
+	}
+#endif
+}
+
+
+/**
+  * @brief   This function parses received sentences and calls appropriate callbacks
+  * @note	 Ensure this is invoked periodically from the main loop or a task, not from an interrupt.
+  * 		 Receiving only queues sentences, so callbacks are never called within an interrupt.
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+void NEO6M_Process(NEO6M_Handle_t *handle)
+{
+	uint32_t meas_rate = handle->measRate ? handle->measRate : 1000;
+
+	while(process_sentence(handle));
+
+	//Delivers the epoch, that some messages were lost of, after a half of measurement period
+	if(handle->navSolution.messages && HAL_GetTick() - handle->navStart >= meas_rate / 2)
+	{
+		epoch_deliver(handle);
+	}
+
+	if(handle->aidingSaving && HAL_GetTick() - handle->aidingPolled >= NEO6M_AIDING_TIMEOUT)
+	{
+		aiding_finish(handle);
+	}
+
+	if((handle->trackers & NEO_TRACK_AIDING) && HAL_GetTick() - handle->aidingPolled >= NEO6M_AIDING_PERIOD)
+	{
+		aiding_poll(handle);
+	}
+}
+
+
+/**
+  * @brief   This function handles bytes that DMA placed to the circular buffer since the previous event
+  * @note	 Ensure this is invoked within the HAL_UARTEx_RxEventCallback for proper operation.
+  * 		 The UART RX DMA stream must be configured in circular mode.
+  * 		 Used only with NEO6M_RECEIVE_DMA receive mode, see @receive_modes in .h file
+  * @param   *handler: Pointer to the handler structure.
+  * @param   size: Position in the DMA buffer up to which data is received (Size argument of the callback)
+  * @retval  None
+  */
+void NEO6M_RxEventHandler(NEO6M_Handle_t *handle, uint16_t size)
+{
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_DMA
+	//On full transfer event DMA position already wrapped to the start of the buffer
+	if(size >= RX_RING_SIZE)
+	{
+		size = 0;
+	}
+
+	//Handles new bytes, idle line event could happen several times at the same position
+	while(handle->dmaPos != size)
+	{
+		receive_byte(handle, handle->rxRing[handle->dmaPos++]);
+
+		//Wraps around the end of circular buffer
+		if(handle->dmaPos >= RX_RING_SIZE)
+		{
+			handle->dmaPos = 0;
+		}
+	}
+#endif
+}
+
+
+/**
+  * @brief   This function restarts receiving after UART error (overrun, noise, framing), when HAL aborts it
+  * @note	 Ensure this is invoked within the HAL_UART_ErrorCallback for proper operation.
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+void NEO6M_ErrorHandler(NEO6M_Handle_t *handle)
+{
+	//Drops the broken message
+	handle->rxCounter = 0;
+	handle->stats.errors++;
+
+	if(handle->rxArmed)
+	{
+		stop_receive(handle);
+		start_receive(handle);
+	}
+}
+
+
+/**
+  * @brief   This function reads received bytes directly from the UART data register
+  * @note	 Ensure this is invoked within the UART interrupt handler instead of HAL_UART_IRQHandler.
+  * 		 Used only with NEO6M_RECEIVE_LL receive mode, see @receive_modes in .h file
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+void NEO6M_IRQHandler(NEO6M_Handle_t *handle)
+{
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_LL
+	USART_TypeDef *usart = handle->huart->Instance;
+	uint32_t sr = LL_USART_ReadReg(usart, SR);
+
+	while(sr & (USART_SR_RXNE | USART_SR_ORE))
+	{
+		//Reading of data register after status register clears the flags
+		char byte = LL_USART_ReceiveData8(usart);
+
+		//Drops the broken message
+		if(sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE))
+		{
+			handle->rxCounter = 0;
+			handle->stats.errors++;
+		}
+
+		receive_byte(handle, byte);
+		sr = LL_USART_ReadReg(usart, SR);
+	}
+#endif
+}
+
+
+/**
+  * @brief   These functions call appropriate handler function of the receiver, that uses the UART
+  * @note	 Ensure these are invoked within HAL_UART_RxCpltCallback, HAL_UARTEx_RxEventCallback,
+  * 		 HAL_UART_ErrorCallback and UART interrupt handler (with NEO6M_RECEIVE_LL receive mode) accordingly.
+  * 		 UARTs that aren't used with receivers are ignored.
+  * @param   *huart: Pointer to the UART handle, argument of the HAL callback
+  * @param   size: Size argument of the HAL_UARTEx_RxEventCallback
+  * @retval  None
+  */
+void NEO6M_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	NEO6M_Handle_t *handle = neo6m_handles[uart_index(huart)];
+
+	if(handle != NULL && handle->huart == huart)
+	{
+		NEO6M_MessageHandler(handle);
+	}
+}
+
+void NEO6M_UART_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size)
+{
+	NEO6M_Handle_t *handle = neo6m_handles[uart_index(huart)];
+
+	if(handle != NULL && handle->huart == huart)
+	{
+		NEO6M_RxEventHandler(handle, size);
+	}
+}
+
+void NEO6M_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	NEO6M_Handle_t *handle = neo6m_handles[uart_index(huart)];
+
+	if(handle != NULL && handle->huart == huart)
+	{
+		NEO6M_ErrorHandler(handle);
+	}
+}
+
+void NEO6M_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+	NEO6M_Handle_t *handle = neo6m_handles[uart_index(huart)];
+
+	if(handle != NULL && handle->huart == huart)
+	{
+		NEO6M_IRQHandler(handle);
+	}
+}
+
+
+/*********************************************************************************************
+ *								NMEA standard messages descriptors
+ ********************************************************************************************/
+
+#define GSV_BLOCK(n)	NMEA_FIELD(3 + 4 * (n), FIELD_U8, GSV_Package_t, repeated_block[n].sv), \
+						NMEA_FIELD(4 + 4 * (n), FIELD_U8, GSV_Package_t, repeated_block[n].elv), \
+						NMEA_FIELD(5 + 4 * (n), FIELD_U16, GSV_Package_t, repeated_block[n].az), \
+						NMEA_FIELD(6 + 4 * (n), FIELD_U8, GSV_Package_t, repeated_block[n].cno)
+
+static const FieldDescriptor_t GLL_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_COORD, GLL_Package_t, latitude),
+		NMEA_FIELD(1, FIELD_CHAR, GLL_Package_t, ns),
+		NMEA_FIELD(2, FIELD_COORD, GLL_Package_t, longitude),
+		NMEA_FIELD(3, FIELD_CHAR, GLL_Package_t, ew),
+		NMEA_FIELD(4, FIELD_U32, GLL_Package_t, time),
+		NMEA_FIELD(4, FIELD_TIME, GLL_Package_t, timeMs),
+		NMEA_FIELD(5, FIELD_CHAR, GLL_Package_t, valid),
+		NMEA_FIELD(6, FIELD_CHAR, GLL_Package_t, mode)
+};
+
+static const FieldDescriptor_t GGA_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_U32, GGA_Package_t, time),
+		NMEA_FIELD(0, FIELD_TIME, GGA_Package_t, timeMs),
+		NMEA_FIELD(1, FIELD_COORD, GGA_Package_t, latitude),
+		NMEA_FIELD(2, FIELD_CHAR, GGA_Package_t, ns),
+		NMEA_FIELD(3, FIELD_COORD, GGA_Package_t, longitude),
+		NMEA_FIELD(4, FIELD_CHAR, GGA_Package_t, ew),
+		NMEA_FIELD(5, FIELD_U8, GGA_Package_t, fs),
+		NMEA_FIELD(6, FIELD_U8, GGA_Package_t, noSV),
+		NMEA_FIELD(7, FIELD_REAL, GGA_Package_t, hdop),
+		NMEA_FIELD(8, FIELD_REAL, GGA_Package_t, msl),
+		NMEA_FIELD(9, FIELD_CHAR, GGA_Package_t, uMsl),
+		NMEA_FIELD(10, FIELD_REAL, GGA_Package_t, altref),
+		NMEA_FIELD(11, FIELD_CHAR, GGA_Package_t, uSep),
+		NMEA_FIELD(12, FIELD_U8, GGA_Package_t, diffAge),
+		NMEA_FIELD(13, FIELD_U8, GGA_Package_t, diffStation)
+};
+
+static const FieldDescriptor_t GSA_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_CHAR, GSA_Package_t, sMode),
+		NMEA_FIELD(1, FIELD_U8, GSA_Package_t, fs),
+		NMEA_FIELD(2, FIELD_U8, GSA_Package_t, sv[0]),
+		NMEA_FIELD(3, FIELD_U8, GSA_Package_t, sv[1]),
+		NMEA_FIELD(4, FIELD_U8, GSA_Package_t, sv[2]),
+		NMEA_FIELD(5, FIELD_U8, GSA_Package_t, sv[3]),
+		NMEA_FIELD(6, FIELD_U8, GSA_Package_t, sv[4]),
+		NMEA_FIELD(7, FIELD_U8, GSA_Package_t, sv[5]),
+		NMEA_FIELD(8, FIELD_U8, GSA_Package_t, sv[6]),
+		NMEA_FIELD(9, FIELD_U8, GSA_Package_t, sv[7]),
+		NMEA_FIELD(10, FIELD_U8, GSA_Package_t, sv[8]),
+		NMEA_FIELD(11, FIELD_U8, GSA_Package_t, sv[9]),
+		NMEA_FIELD(12, FIELD_U8, GSA_Package_t, sv[10]),
+		NMEA_FIELD(13, FIELD_U8, GSA_Package_t, sv[11]),
+		NMEA_FIELD(14, FIELD_REAL, GSA_Package_t, pdop),
+		NMEA_FIELD(15, FIELD_REAL, GSA_Package_t, hdop),
+		NMEA_FIELD(16, FIELD_REAL, GSA_Package_t, vdop)
+};
+
+//Last part of GSV message could have less blocks, missing fields stay zero
+static const FieldDescriptor_t GSV_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_U8, GSV_Package_t, noMsg),
+		NMEA_FIELD(1, FIELD_U8, GSV_Package_t, msgNo),
+		NMEA_FIELD(2, FIELD_U8, GSV_Package_t, noSV),
+		GSV_BLOCK(0),
+		GSV_BLOCK(1),
+		GSV_BLOCK(2),
+		GSV_BLOCK(3)
+};
+
+static const FieldDescriptor_t RMC_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_U32, RMC_Package_t, time),
+		NMEA_FIELD(0, FIELD_TIME, RMC_Package_t, timeMs),
+		NMEA_FIELD(1, FIELD_CHAR, RMC_Package_t, status),
+		NMEA_FIELD(2, FIELD_COORD, RMC_Package_t, latitude),
+		NMEA_FIELD(3, FIELD_CHAR, RMC_Package_t, ns),
+		NMEA_FIELD(4, FIELD_COORD, RMC_Package_t, longitude),
+		NMEA_FIELD(5, FIELD_CHAR, RMC_Package_t, ew),
+		NMEA_FIELD(6, FIELD_REAL, RMC_Package_t, spd),
+		NMEA_FIELD(7, FIELD_REAL, RMC_Package_t, cog),
+		NMEA_FIELD(8, FIELD_U32, RMC_Package_t, date),
+		NMEA_FIELD(9, FIELD_REAL, RMC_Package_t, mv),
+		NMEA_FIELD(10, FIELD_CHAR, RMC_Package_t, mvE),
+		NMEA_FIELD(11, FIELD_CHAR, RMC_Package_t, mode)
+};
+
+static const FieldDescriptor_t VTG_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_REAL, VTG_Package_t, cogt),
+		NMEA_FIELD(1, FIELD_CHAR, VTG_Package_t, true),
+		NMEA_FIELD(2, FIELD_U8, VTG_Package_t, cogm),
+		NMEA_FIELD(3, FIELD_CHAR, VTG_Package_t, magnetic),
+		NMEA_FIELD(4, FIELD_REAL, VTG_Package_t, sog),
+		NMEA_FIELD(5, FIELD_CHAR, VTG_Package_t, knots),
+		NMEA_FIELD(6, FIELD_REAL, VTG_Package_t, kph),
+		NMEA_FIELD(7, FIELD_CHAR, VTG_Package_t, kilometers),
+		NMEA_FIELD(8, FIELD_CHAR, VTG_Package_t, mode)
+};
+
+static const FieldDescriptor_t DTM_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_STRING, DTM_Package_t, lll),
+		NMEA_FIELD(1, FIELD_STRING, DTM_Package_t, lsd),
+		NMEA_FIELD(2, FIELD_REAL, DTM_Package_t, lat),
+		NMEA_FIELD(3, FIELD_CHAR, DTM_Package_t, ns),
+		NMEA_FIELD(4, FIELD_REAL, DTM_Package_t, lon),
+		NMEA_FIELD(5, FIELD_CHAR, DTM_Package_t, ew),
+		NMEA_FIELD(6, FIELD_REAL, DTM_Package_t, alt),
+		NMEA_FIELD(7, FIELD_STRING, DTM_Package_t, rrr)
+};
+
+static const FieldDescriptor_t GBS_FIELDS[] =
+{
+		NMEA_FIELD(0, FIELD_U32, GBS_Package_t, time),
+		NMEA_FIELD(0, FIELD_TIME, GBS_Package_t, timeMs),
+		NMEA_FIELD(1, FIELD_REAL, GBS_Package_t, errlat),
+		NMEA_FIELD(2, FIELD_REAL, GBS_Package_t, errlon),
+		NMEA_FIELD(3, FIELD_REAL, GBS_Package_t, erralt),
+		NMEA_FIELD(4, FIELD_U8, GBS_Package_t, svid),
+		NMEA_FIELD(5, FIELD_REAL, GBS_Package_t, prob),
+		NMEA_FIELD(6, FIELD_REAL, GBS_Package_t, bias),
+		NMEA_FIELD(7, FIELD_REAL, GBS_Package_t, stddev)
+};
+
+//Field 0 of PUBX sentences is the message ID
+static const FieldDescriptor_t PUBX00_FIELDS[] =
+{
+		NMEA_FIELD(1, FIELD_U32, PUBX00_Package_t, time),
+		NMEA_FIELD(1, FIELD_TIME, PUBX00_Package_t, timeMs),
+		NMEA_FIELD(2, FIELD_COORD, PUBX00_Package_t, latitude),
+		NMEA_FIELD(3, FIELD_CHAR, PUBX00_Package_t, ns),
+		NMEA_FIELD(4, FIELD_COORD, PUBX00_Package_t, longitude),
+		NMEA_FIELD(5, FIELD_CHAR, PUBX00_Package_t, ew),
+		NMEA_FIELD(6, FIELD_REAL, PUBX00_Package_t, altRef),
+		NMEA_FIELD(7, FIELD_STRING, PUBX00_Package_t, navStat),
+		NMEA_FIELD(8, FIELD_REAL, PUBX00_Package_t, hAcc),
+		NMEA_FIELD(9, FIELD_REAL, PUBX00_Package_t, vAcc),
+		NMEA_FIELD(10, FIELD_REAL, PUBX00_Package_t, sog),
+		NMEA_FIELD(11, FIELD_REAL, PUBX00_Package_t, cog),
+		NMEA_FIELD(12, FIELD_REAL, PUBX00_Package_t, vVel),
+		NMEA_FIELD(13, FIELD_U16, PUBX00_Package_t, diffAge),
+		NMEA_FIELD(14, FIELD_REAL, PUBX00_Package_t, hdop),
+		NMEA_FIELD(15, FIELD_REAL, PUBX00_Package_t, vdop),
+		NMEA_FIELD(16, FIELD_REAL, PUBX00_Package_t, tdop),
+		NMEA_FIELD(17, FIELD_U8, PUBX00_Package_t, numSvs)
+};
+
+#define PUBX03_BLOCK(n)	NMEA_FIELD(2 + 6 * (n), FIELD_U8, PUBX03_Package_t, repeated_block[n].sv), \
+						NMEA_FIELD(3 + 6 * (n), FIELD_CHAR, PUBX03_Package_t, repeated_block[n].status), \
+						NMEA_FIELD(4 + 6 * (n), FIELD_U16, PUBX03_Package_t, repeated_block[n].az), \
+						NMEA_FIELD(5 + 6 * (n), FIELD_U8, PUBX03_Package_t, repeated_block[n].elv), \
+						NMEA_FIELD(6 + 6 * (n), FIELD_U8, PUBX03_Package_t, repeated_block[n].cno), \
+						NMEA_FIELD(7 + 6 * (n), FIELD_U8, PUBX03_Package_t, repeated_block[n].lck)
+
+//Blocks of satellites, that aren't tracked, stay zero
+static const FieldDescriptor_t PUBX03_FIELDS[] =
+{
+		NMEA_FIELD(1, FIELD_U8, PUBX03_Package_t, n),
+		PUBX03_BLOCK(0), PUBX03_BLOCK(1), PUBX03_BLOCK(2), PUBX03_BLOCK(3),
+		PUBX03_BLOCK(4), PUBX03_BLOCK(5), PUBX03_BLOCK(6), PUBX03_BLOCK(7),
+		PUBX03_BLOCK(8), PUBX03_BLOCK(9), PUBX03_BLOCK(10), PUBX03_BLOCK(11),
+		PUBX03_BLOCK(12), PUBX03_BLOCK(13), PUBX03_BLOCK(14), PUBX03_BLOCK(15)
+};
+
+static const FieldDescriptor_t PUBX04_FIELDS[] =
+{
+		NMEA_FIELD(1, FIELD_U32, PUBX04_Package_t, time),
+		NMEA_FIELD(1, FIELD_TIME, PUBX04_Package_t, timeMs),
+		NMEA_FIELD(2, FIELD_U32, PUBX04_Package_t, date),
+		NMEA_FIELD(3, FIELD_REAL, PUBX04_Package_t, utcTow),
+		NMEA_FIELD(4, FIELD_U16, PUBX04_Package_t, utcWk),
+		NMEA_FIELD(5, FIELD_U8, PUBX04_Package_t, leapSec),
+		NMEA_FIELD(6, FIELD_I32, PUBX04_Package_t, clkBias),
+		NMEA_FIELD(7, FIELD_REAL, PUBX04_Package_t, clkDrift),
+		NMEA_FIELD(8, FIELD_U32, PUBX04_Package_t, tpGran)
+};
+
+
+/*
+ * Descriptors of NMEA standard messages packages, indexed by message type
+ */
+static const PackageDescriptor_t NMEA_PACKAGES[] =
+{
+		{NULL, 0, 0, 0, NULL},	/* EMPTY */
+		NMEA_PACKAGE(GLL_Package_t, GLL_FIELDS, NULL),
+		NMEA_PACKAGE(GGA_Package_t, GGA_FIELDS, NULL),
+		NMEA_PACKAGE(GSA_Package_t, GSA_FIELDS, NULL),
+		NMEA_PACKAGE(GSV_Package_t, GSV_FIELDS, NULL),
+		NMEA_PACKAGE(RMC_Package_t, RMC_FIELDS, &rmc_finish),
+		NMEA_PACKAGE(VTG_Package_t, VTG_FIELDS, NULL),
+		NMEA_PACKAGE(DTM_Package_t, DTM_FIELDS, NULL),
+		NMEA_PACKAGE(GBS_Package_t, GBS_FIELDS, NULL),
+		NMEA_PACKAGE(PUBX00_Package_t, PUBX00_FIELDS, NULL),
+		NMEA_PACKAGE(PUBX03_Package_t, PUBX03_FIELDS, NULL),
+		NMEA_PACKAGE(PUBX04_Package_t, PUBX04_FIELDS, &pubx04_finish)
+};
+
+
+/*********************************************************************************************
+ *									Sentence field accessors
+ ********************************************************************************************/
+
+/**
+  * @brief   This function returns count of the fields of the sentence
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @retval  uint8_t Count of the fields, including ones that positions weren't recorded for (PUBX,03)
+  */
+uint8_t NEO6M_GetFieldsCount(const NEO6M_Sentence_t *sentence)
+{
+	uint8_t count = sentence->view.fieldsCount;
+	uint16_t position = count ? sentence->view.fields[count - 1] : 0;
+
+	while(position && (position = view_next_field(&sentence->view, position)))
+	{
+		count++;
+	}
+
+	return count;
+}
+
+
+/**
+  * @brief   This function returns character field of the sentence
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @param   field: Index of the field, 0 - first field after address
+  * @retval  char Character, 0 for empty or missing field
+  */
+char NEO6M_GetChar(NEO6M_Sentence_t *sentence, uint8_t field)
+{
+	return (char)sentence_value(sentence, field, FIELD_CHAR);
+}
+
+
+/**
+  * @brief   This function decodes integer field of the sentence (e.g. date, satellites count), could be negative
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @param   field: Index of the field, 0 - first field after address
+  * @retval  int32_t Value, 0 for empty or missing field
+  */
+int32_t NEO6M_GetInt(NEO6M_Sentence_t *sentence, uint8_t field)
+{
+	return sentence_value(sentence, field, FIELD_I32);
+}
+
+
+/**
+  * @brief   This function decodes time field of the sentence (hhmmss.ss)
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @param   field: Index of the field, 0 - first field after address
+  * @retval  uint32_t Milliseconds since midnight, 0 for empty or missing field
+  */
+uint32_t NEO6M_GetTime(NEO6M_Sentence_t *sentence, uint8_t field)
+{
+	return sentence_value(sentence, field, FIELD_TIME);
+}
+
+
+/**
+  * @brief   This function decodes field of the sentence with fractional part (e.g. speed, altitude, DOP)
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @param   field: Index of the field, 0 - first field after address
+  * @retval  NEO6M_Real_t Value, 0 for empty or missing field
+  */
+NEO6M_Real_t NEO6M_GetReal(NEO6M_Sentence_t *sentence, uint8_t field)
+{
+#if NEO6M_NUMERIC_FORMAT == NEO6M_NUMERIC_FIXED
+	return sentence_value(sentence, field, FIELD_REAL);
+#else
+	return (float)sentence_value(sentence, field, FIELD_REAL) / NEO6M_FIXED_SCALE;
+#endif
+}
+
+
+/**
+  * @brief   This function decodes coordinate field of the sentence, N/S or E/W indicator is the next field
+  * @param   *sentence: Pointer to the sentence received by NEO6M_SentenceCallBack
+  * @param   field: Index of the latitude or longitude field
+  * @retval  NEO6M_Coord_t Coordinate, negative for S and W, 0 for empty or missing field
+  */
+NEO6M_Coord_t NEO6M_GetCoord(NEO6M_Sentence_t *sentence, uint8_t field)
+{
+#if NEO6M_NUMERIC_FORMAT == NEO6M_NUMERIC_FIXED
+	return sentence_value(sentence, field, FIELD_COORD);
+#else
+	return (NEO6M_Coord_t)sentence_value(sentence, field, FIELD_COORD) / NEO6M_COORD_SCALE;
+#endif
+}
+
+
+/**
+  * @brief   This function decodes field of the sentence, or returns its cached value if it was decoded before
+  * @note	 Only values of the fields, that positions were recorded for, are cached
+  * @param   *sentence: Pointer to the sentence
+  * @param   field: Index of the field
+  * @param   kind: Format of the value, see FieldFormat_t; real values and coordinates are fixed point
+  * @retval  int32_t Value of the field
+  */
+static int32_t sentence_value(NEO6M_Sentence_t *sentence, uint8_t field, FieldFormat_t kind)
+{
+	uint16_t position;
+	uint16_t indicator;
+	int32_t value;
+	char c;
+
+	//Kind is stored incremented, so 0 means that field isn't decoded yet
+	if(field < sentence->view.fieldsCount && sentence->kinds[field] == kind + 1)
+	{
+		return sentence->values[field];
+	}
+
+	position = view_field(&sentence->view, field);
+	if(!position)
+	{
+		return 0;
+	}
+
+	switch(kind)
+	{
+		case FIELD_CHAR:
+		{
+			c = view_char(&sentence->view, position);
+			value = (c == ',' || c == '*') ? 0 : c;
+			break;
+		}
+		case FIELD_I32:
+		{
+			value = view_to_fixed(&sentence->view, position, 0);
+			break;
+		}
+		case FIELD_REAL:
+		{
+			value = view_to_fixed(&sentence->view, position, 3);
+			break;
+		}
+		case FIELD_TIME:
+		{
+			value = view_to_time(&sentence->view, position);
+			break;
+		}
+		case FIELD_COORD:
+		{
+			indicator = view_field(&sentence->view, field + 1);
+			c = indicator ? view_char(&sentence->view, indicator) : 0;
+			value = coord_to_fixed(&sentence->view, position, c);
+			break;
+		}
+		default:
+		{
+			value = view_to_int(&sentence->view, position, 10);
+		}
+	}
+
+	if(field < sentence->view.fieldsCount)
+	{
+		sentence->kinds[field] = kind + 1;
+		sentence->values[field] = value;
+	}
+
+	return value;
+}
+
+
+/*********************************************************************************************
+ *										Receiving functions
+ ********************************************************************************************/
+
+/**
+  * @brief   This function starts receiving from module according to the receive mode
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  0 - if successfully, otherwise - 1
+  */
+static uint8_t start_receive(NEO6M_Handle_t *handle)
+{
+	HAL_StatusTypeDef status;
+
+	//Set before receiving is started, so the first byte already requests the next one
+	handle->rxArmed = 1;
+
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_DMA
+	//DMA writes from the start of the ring, so stream position is aligned to it
+	handle->dmaPos = 0;
+	handle->rxTotal = (handle->rxTotal + RX_RING_SIZE - 1) & ~(RX_RING_SIZE - 1);
+	status = HAL_UARTEx_ReceiveToIdle_DMA(handle->huart, handle->rxRing, RX_RING_SIZE);
+#elif NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_LL
+	//Drops the byte, that could be received before
+	LL_USART_ReceiveData8(handle->huart->Instance);
+	LL_USART_EnableIT_RXNE(handle->huart->Instance);
+	status = HAL_OK;
+#else
+	status = HAL_UART_Receive_IT(handle->huart, (uint8_t *)&handle->rcvdByte, 1);
+#endif
+
+	if(status != HAL_OK)
+	{
+		handle->rxArmed = 0;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/**
+  * @brief   This function stops receiving from module
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+static void stop_receive(NEO6M_Handle_t *handle)
+{
+	//Cleared before receiving is stopped, so the byte being handled doesn't request the next one
+	handle->rxArmed = 0;
+
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_LL
+	LL_USART_DisableIT_RXNE(handle->huart->Instance);
+#else
+	HAL_UART_AbortReceive(handle->huart);
+#endif
+}
+
+
+/**
+  * @brief   This function frames received bytes to sentences, and queues sentence if end sequence happened
+  * @note	 Sentence always starts from '$', so '$' restarts the sentence being received and bytes before
+  * 		 first '$' are dropped. Sentences longer than NMEA_MAX_SENTENCE_LENGTH and sentences with
+  * 		 invalid or missing checksum are dropped.
+  * 		 Sentence is tokenized in the queue slot being filled (head slot isn't read by processing):
+  * 		 its type, positions of the fields and checksum are ready as soon as end sequence is received.
+  * 		 Only expected sentences are queued, so unexpected ones don't fill the ring and the queue.
+  * 		 In DMA mode the byte is already placed in the receive ring, otherwise it's placed here.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   byte: Received byte
+  * @retval  None
+  */
+static void receive_byte(NEO6M_Handle_t *handler, char byte)
+{
+	uint32_t position = handler->rxTotal;
+	uint8_t head = handler->queueHead;
+	NEO6M_SentenceSlot_t *slot = &handler->rxQueue[head];
+
+#if NEO6M_RECEIVE_MODE != NEO6M_RECEIVE_DMA
+	//Doesn't overwrite sentences that weren't processed yet, drops the sentence being received instead
+	if(head != handler->queueTail && position - handler->rxQueue[handler->queueTail].start >= RX_RING_SIZE)
+	{
+		if(handler->rxCounter)
+		{
+			handler->rxCounter = 0;
+			handler->stats.dropped++;
+		}
+
+		//Acknowledges don't need the ring, so UBX frames are still framed (while configuration waits for them),
+		//but they aren't queued
+		if(handler->ubxState != UBX_STATE_IDLE || (uint8_t)byte == UBX_SYNC_CHAR_1)
+		{
+			handler->ubxDropped = 1;
+			ubx_receive_byte(handler, (uint8_t)byte);
+		}
+		return;
+	}
+
+	handler->rxRing[position & (RX_RING_SIZE - 1)] = byte;
+#endif
+	handler->rxTotal = position + 1;
+
+	//Demultiplexes UBX frames and NMEA sentences. NMEA sentences are printable ASCII, so the first UBX sync character
+	//can't be part of a sentence, and it aborts unfinished one. '$' inside of UBX frame is a part of its payload
+	if(handler->ubxState != UBX_STATE_IDLE || (uint8_t)byte == UBX_SYNC_CHAR_1)
+	{
+		if(handler->rxCounter)
+		{
+			handler->rxCounter = 0;
+			handler->stats.resyncs++;
+		}
+
+		if(handler->ubxState == UBX_STATE_IDLE)
+		{
+			handler->ubxDropped = 0;
+		}
+
+		//Byte is passed to the NMEA framer if the frame isn't synchronised (second sync character is wrong)
+		if(ubx_receive_byte(handler, (uint8_t)byte))
+		{
+			return;
+		}
+	}
+
+	//Start of sentence, resynchronises if previous one wasn't finished
+	if(byte == '$')
+	{
+		if(handler->rxCounter)
+		{
+			handler->stats.resyncs++;
+		}
+		slot->start = position;
+		slot->type = EMPTY;
+		slot->checksum = 0;
+		slot->fieldsCount = 0;
+		handler->rxAddress = 0;
+		handler->rxChecksum = 0;
+		handler->rxChecksumField = 0;
+		handler->rxCounter = 1;
+		return;
+	}
+
+	//Drops bytes until start of sentence
+	if(!handler->rxCounter)
+	{
+		handler->stats.garbage++;
+		return;
+	}
+
+	handler->rxCounter++;
+
+	//Checks for end sequence
+	if(byte == '\n')
+	{
+		//Drops corrupted sentence before it's parsed
+		if(!handler->rxChecksumField || slot->checksum != handler->rxChecksum)
+		{
+			handler->stats.corrupted++;
+		}
+		//Only expected sentences take place in the queue and the ring
+		else if(handler->queueAll || (is_expected(handler, slot->type) && (handler->talkers & slot->talker)))
+		{
+			queue_publish(handler, handler->rxCounter);
+		}
+
+		handler->rxCounter = 0;
+		handler->stats.sentences++;
+		return;
+	}
+
+	//Drops too long sentence, and waits for next '$'. Proprietary sentences are allowed to be longer
+	if(handler->rxCounter >= ((handler->rxAddress == PUBX_ADDRESS) ? NMEA_MAX_PROPRIETARY_LENGTH : NMEA_MAX_SENTENCE_LENGTH))
+	{
+		handler->rxCounter = 0;
+		handler->stats.overflows++;
+		return;
+	}
+
+	//Tokenizes the sentence as it's received, so it's not scanned again while processing
+	if(handler->rxChecksumField)
+	{
+		if(byte >= '0' && byte <= '9')
+		{
+			slot->checksum = (slot->checksum << 4) | (byte - '0');
+		}
+		else if((byte | 0x20) >= 'a' && (byte | 0x20) <= 'f')
+		{
+			slot->checksum = (slot->checksum << 4) | ((byte | 0x20) - 'a' + 10);
+		}
+	}
+	else if(byte == '*')
+	{
+		handler->rxChecksumField = 1;
+	}
+	else
+	{
+		handler->rxChecksum ^= byte;
+
+		if(byte == ',')
+		{
+			//Address field is finished, so type of the sentence is known
+			if(slot->fieldsCount == 0 && handler->rxCounter == NMEA_ADDRESS_LENGTH + 2)
+			{
+				slot->type = message_type(handler->rxAddress);
+				slot->talker = message_talker(handler->rxAddress);
+			}
+			//Type of proprietary sentence is known after message ID, it has no talker and is accepted from any
+			else if(slot->fieldsCount == 1 && handler->rxCounter == PUBX_ID_END && handler->rxAddress == PUBX_ADDRESS)
+			{
+				slot->type = pubx_type(handler->rxRing[(position - 2) & (RX_RING_SIZE - 1)],
+									   handler->rxRing[(position - 1) & (RX_RING_SIZE - 1)]);
+				slot->talker = NEO_TALKER_ALL;
+			}
+
+			//Positions of fields, that don't fit the slot, are found while decoding
+			if(slot->fieldsCount < NEO6M_MAX_FIELDS && handler->rxCounter <= UINT8_MAX)
+			{
+				slot->fields[slot->fieldsCount++] = handler->rxCounter;
+			}
+		}
+		else if(handler->rxCounter <= NMEA_ADDRESS_LENGTH + 1)
+		{
+			handler->rxAddress = NMEA_ADDRESS_PACK(handler->rxAddress, byte);
+		}
+	}
+}
+
+
+/**
+  * @brief   This function publishes the sentence or UBX frame of the head queue slot to processing
+  * @note	 If the queue is full, the sentence is dropped
+  * @param   *handler: Pointer to the handler structure.
+  * @param   length: Length of the sentence or UBX frame
+  * @retval  None
+  */
+static void queue_publish(NEO6M_Handle_t *handler, uint16_t length)
+{
+	uint8_t head = handler->queueHead;
+	uint8_t next = (head + 1) & (SENTENCE_QUEUE_SIZE - 1);
+
+	if(next != handler->queueTail)
+	{
+		handler->rxQueue[head].length = length;
+
+		//Ensures the sentence is written before its index is published
+		__DMB();
+		handler->queueHead = next;
+	}
+	else
+	{
+		handler->stats.dropped++;
+	}
+}
+
+
+/**
+  * @brief   This function decodes the sentence and calls appropriate callback, if its message type is expected
+  * 		 from its talker. If it's expected as sentence, it's passed to NEO6M_SentenceCallBack not decoded.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *sentence: Received sentence
+  * @param   *slot: Queue slot of the sentence, with type and talker found while receiving
+  * @retval  None
+  */
+static void dispatch_sentence(NEO6M_Handle_t *handler, const NEO6M_SentenceView_t *sentence, const NEO6M_SentenceSlot_t *slot)
+{
+	NMEA_Package_t package;
+	NEO6M_Sentence_t lazy;
+
+	//Type of unsupported sentence is EMPTY, it's never expected
+	if(!is_expected(handler, slot->type) || !(handler->talkers & slot->talker))
+	{
+		return;
+	}
+
+	//Package is decoded once for user and trackers
+	if(((handler->subscriptions | handler->trackingSubscriptions) >> slot->type) & 1)
+	{
+		memset(&package, 0, sizeof(package));
+		if(slot->type >= FIRST_UBX_TYPE)
+		{
+			ubx_decode(sentence, slot->type, &package);
+		}
+		else
+		{
+			nmea_decode(sentence, &NMEA_PACKAGES[slot->type], &package);
+		}
+
+		//DMA could overwrite the sentence while it was decoded
+		if(!is_intact(handler, slot))
+		{
+			handler->stats.overwritten++;
+			return;
+		}
+
+		if((handler->subscriptions >> slot->type) & 1)
+		{
+			NMEA_STANDART_MESSAGGES[slot->type].callback(&package);
+		}
+		if((handler->trackingSubscriptions >> slot->type) & 1)
+		{
+			track_message(handler, slot->type, sentence, &package);
+		}
+	}
+
+	//Fields of the sentence are decoded only when callback reads them
+	if((handler->sentenceSubscriptions >> slot->type) & 1)
+	{
+		lazy.view = *sentence;
+		lazy.type = slot->type;
+		lazy.talker[0] = view_char(sentence, 1);
+		lazy.talker[1] = view_char(sentence, 2);
+		lazy.talker[2] = '\0';
+		memset(lazy.kinds, 0, sizeof(lazy.kinds));
+		NEO6M_SentenceCallBack(&lazy);
+
+		//DMA could overwrite the sentence while callback read it, values that were read aren't valid then
+		if(!is_intact(handler, slot))
+		{
+			handler->stats.overwritten++;
+		}
+	}
+}
+
+
+/**
+  * @brief   This function takes the oldest received sentence from the queue and dispatches it
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  1 - if sentence was taken, 0 - if queue is empty
+  */
+static uint8_t process_sentence(NEO6M_Handle_t *handle)
+{
+	uint8_t tail = handle->queueTail;
+	NEO6M_SentenceSlot_t slot;
+	NEO6M_SentenceView_t sentence;
+	uint32_t offset;
+
+	if(tail == handle->queueHead)
+	{
+		return 0;
+	}
+
+	//Ensures the sentence is read only after its index was published
+	__DMB();
+	slot = handle->rxQueue[tail];
+
+	//Sentence is parsed in place, second segment is used if it wraps around the end of the receive ring
+	offset = slot.start & (RX_RING_SIZE - 1);
+	sentence.data[0] = (const char *)&handle->rxRing[offset];
+	sentence.length[0] = (slot.length < RX_RING_SIZE - offset) ? slot.length : RX_RING_SIZE - offset;
+	sentence.data[1] = (const char *)handle->rxRing;
+	sentence.length[1] = slot.length - sentence.length[0];
+	sentence.fields = slot.fields;
+	sentence.fieldsCount = slot.fieldsCount;
+	sentence.checksum = slot.checksum;
+
+	//In DMA mode the sentence could be overwritten, if it wasn't processed in time
+	if(is_intact(handle, &slot))
+	{
+		dispatch_sentence(handle, &sentence, &slot);
+	}
+	else
+	{
+		handle->stats.overwritten++;
+	}
+
+	//Frees the queue slot
+	handle->queueTail = (tail + 1) & (SENTENCE_QUEUE_SIZE - 1);
+
+	return 1;
+}
+
+
+/**
+  * @brief   This function checks that the sentence wasn't overwritten in the receive ring
+  * @note	 In DMA mode bytes are written to the ring before receive_byte handles them, so the live write
+  * 		 position is found by DMA counter. In other modes sentences aren't overwritten before processing.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *slot: Queue slot of the sentence
+  * @retval  1 - if sentence is intact, 0 - if it was overwritten
+  */
+static uint8_t is_intact(NEO6M_Handle_t *handle, const NEO6M_SentenceSlot_t *slot)
+{
+	uint32_t position;
+#if NEO6M_RECEIVE_MODE == NEO6M_RECEIVE_DMA
+	uint16_t write;
+	uint16_t handled;
+
+	//Position and handled bytes are updated by interrupt, so they're read until they're consistent
+	do
+	{
+		position = handle->rxTotal;
+		handled = *(volatile uint16_t *)&handle->dmaPos;
+		write = (RX_RING_SIZE - __HAL_DMA_GET_COUNTER(handle->huart->hdmarx)) & (RX_RING_SIZE - 1);
+	}
+	while(position != handle->rxTotal);
+
+	//Bytes written by DMA, but not handled yet
+	position += (write - handled) & (RX_RING_SIZE - 1);
+#else
+	position = handle->rxTotal;
+#endif
+
+	return (position - slot->start <= RX_RING_SIZE);
+}
+
+
+/**
+  * @brief   This function processes received sentences, until sentence with valid checksum is received
+  * @note	 Sentences with invalid checksum are dropped while receiving, so any queued sentence is valid.
+  * 		 Sentences, that started before the position, are processed, but don't complete waiting.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   timeout: Time (ms) to wait for the sentence
+  * @param   since: Position in the receive stream, that the sentence must start at or after
+  * @retval  0 - if valid sentence was received, otherwise - 1
+  */
+static uint8_t wait_valid_sentence(NEO6M_Handle_t *handle, uint32_t timeout, uint32_t since)
+{
+	uint32_t start = HAL_GetTick();
+	uint32_t position;
+
+	while(HAL_GetTick() - start < timeout)
+	{
+		if(handle->queueTail == handle->queueHead)
+		{
+			continue;
+		}
+
+		position = handle->rxQueue[handle->queueTail].start;
+		if(process_sentence(handle) && (int32_t)(position - since) >= 0)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+/**
+  * @brief   This function reinitializes the UART with another baud rate, and waits for valid sentence
+  * @param   *handler: Pointer to the handler structure.
+  * @param   baudrate: New baud rate
+  * @retval  0 - if valid sentence was received, otherwise - 1
+  */
+static uint8_t switch_baudrate(NEO6M_Handle_t *handle, uint32_t baudrate)
+{
+	uint8_t status;
+
+	stop_receive(handle);
+
+	handle->huart->Init.BaudRate = baudrate;
+	if(HAL_UART_Init(handle->huart) != HAL_OK)
+	{
+		return 1;
+	}
+
+	//Drops sentences and frames received at the previous baud rate, they don't verify the switch
+	handle->queueTail = handle->queueHead;
+	handle->rxCounter = 0;
+	handle->ubxState = UBX_STATE_IDLE;
+
+	//Receives and queues sentences even if no messages are expected, to verify the switch
+	if(start_receive(handle))
+	{
+		return 1;
+	}
+	handle->queueAll = 1;
+	status = wait_valid_sentence(handle, NEO6M_CONFIG_TIMEOUT, handle->rxTotal);
+	handle->queueAll = 0;
+
+	if(handle->receive_status == NEO_FREE)
+	{
+		stop_receive(handle);
+	}
+
+	return status;
+}
+
+
+/*********************************************************************************************
+ *										UBX protocol functions
+ ********************************************************************************************/
+
+/**
+  * @brief   This function sends UBX message to the module
+  * @param   *handler: Pointer to the handler structure.
+  * @param   msg_class: Class of the message
+  * @param   msg_id: ID of the message
+  * @param   *payload: Pointer to the payload of the message
+  * @param   length: Length of the payload
+  * @retval  0 - if successfully, otherwise - 1
+  */
+static uint8_t ubx_send(NEO6M_Handle_t *handle, uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t length)
+{
+	uint8_t header[6] = {UBX_SYNC_CHAR_1, UBX_SYNC_CHAR_2, msg_class, msg_id, (uint8_t)length, (uint8_t)(length >> 8)};
+	uint8_t checksum[2] = {0};
+	uint32_t start;
+
+	//Checksum is computed over class, ID, length and payload
+	ubx_checksum(header + 2, sizeof(header) - 2, checksum);
+	ubx_checksum(payload, length, checksum);
+
+	if(HAL_UART_Transmit(handle->huart, header, sizeof(header), NEO6M_CONFIG_TIMEOUT) != HAL_OK ||
+	   (length && HAL_UART_Transmit(handle->huart, (uint8_t *)payload, length, NEO6M_CONFIG_TIMEOUT) != HAL_OK) ||
+	   HAL_UART_Transmit(handle->huart, checksum, sizeof(checksum), NEO6M_CONFIG_TIMEOUT) != HAL_OK)
+	{
+		return 1;
+	}
+
+	//Waits until the last byte leaves the UART
+	start = HAL_GetTick();
+	while(__HAL_UART_GET_FLAG(handle->huart, UART_FLAG_TC) == RESET)
+	{
+		if(HAL_GetTick() - start >= NEO6M_CONFIG_TIMEOUT)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+  * @brief   This function sends UBX-CFG-PRT message, that configures UART1 port of the module
+  * @note	 Acknowledge isn't waited, it's sent by the module at the previous baud rate
+  * @param   *handler: Pointer to the handler structure.
+  * @param   baudrate: Baud rate of the port
+  * @retval  0 - if successfully, otherwise - 1
+  */
+static uint8_t ubx_send_port(NEO6M_Handle_t *handle, uint32_t baudrate)
+{
+	uint8_t payload[20] = {0};
+
+	payload[0] = UBX_PORT_UART1;
+	payload[4] = (uint8_t)UBX_PORT_MODE_8N1;
+	payload[5] = (uint8_t)(UBX_PORT_MODE_8N1 >> 8);
+	payload[8] = (uint8_t)baudrate;
+	payload[9] = (uint8_t)(baudrate >> 8);
+	payload[10] = (uint8_t)(baudrate >> 16);
+	payload[11] = (uint8_t)(baudrate >> 24);
+	payload[12] = UBX_PROTO_UBX | UBX_PROTO_NMEA;
+	payload[14] = UBX_PROTO_UBX | UBX_PROTO_NMEA;
+
+	return ubx_send(handle, UBX_CLASS_CFG, UBX_CFG_PRT, payload, sizeof(payload));
+}
+
+
+/**
+  * @brief   This function sends UBX-CFG message to the module and waits for the acknowledge
+  * @note	 Acknowledge is received by receiving functions, they are started for a while if needed
+  * @param   *handler: Pointer to the handler structure.
+  * @param   msg_id: ID of the UBX-CFG message
+  * @param   *payload: Pointer to the payload of the message
+  * @param   length: Length of the payload
+  * @retval  0 - if module acknowledged the message, otherwise - 1
+  */
+static uint8_t ubx_send_config(NEO6M_Handle_t *handle, uint8_t msg_id, const uint8_t *payload, uint16_t length)
+{
+	uint16_t message = (UBX_CLASS_CFG << 8) | msg_id;
+	uint8_t stop = !handle->rxArmed;
+	uint8_t flag = 1;
+	uint32_t start;
+
+	//Acknowledge is received even if no messages are expected
+	if(stop && start_receive(handle))
+	{
+		return 1;
+	}
+
+	handle->ackStatus = NEO_ACK_NONE;
+
+	if(!ubx_send(handle, UBX_CLASS_CFG, msg_id, payload, length))
+	{
+		start = HAL_GetTick();
+		while(HAL_GetTick() - start < NEO6M_CONFIG_TIMEOUT)
+		{
+			if(handle->ackStatus != NEO_ACK_NONE && handle->ackMessage == message)
+			{
+				flag = (handle->ackStatus == NEO_ACK_ACK) ? 0 : 1;
+				break;
+			}
+		}
+	}
+
+	if(stop)
+	{
+		stop_receive(handle);
+	}
+
+	return flag;
+}
+
+
+/**
+  * @brief   This function receives UBX frame byte by byte, handles acknowledges and queues supported messages
+  * @note	 Frames are 0xB5 0x62, class, ID, 2 bytes of length, payload and 2 bytes of checksum.
+  * 		 Frame stays in the receive ring, and is queued in the head queue slot as sentences are.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   byte: Received byte
+  * @retval  1 - if byte is part of UBX frame, 0 - if it isn't (second sync character is wrong)
+  */
+static uint8_t ubx_receive_byte(NEO6M_Handle_t *handle, uint8_t byte)
+{
+	uint16_t length = handle->ubxHeader[2] | (handle->ubxHeader[3] << 8);
+	NEO6M_SentenceSlot_t *slot = &handle->rxQueue[handle->queueHead];
+	MessagesTypes_t type;
+
+	switch(handle->ubxState)
+	{
+		case UBX_STATE_IDLE:
+		{
+			slot->start = handle->rxTotal - 1;
+			handle->ubxState = UBX_STATE_SYNC;
+			break;
+		}
+		case UBX_STATE_SYNC:
+		{
+			//Repeated first sync character may start the frame
+			if(byte == UBX_SYNC_CHAR_1)
+			{
+				slot->start = handle->rxTotal - 1;
+				break;
+			}
+			if(byte != UBX_SYNC_CHAR_2)
+			{
+				handle->ubxState = UBX_STATE_IDLE;
+				return 0;
+			}
+			handle->ubxState = UBX_STATE_HEADER;
+			handle->ubxCounter = 0;
+			handle->ubxChecksum[0] = 0;
+			handle->ubxChecksum[1] = 0;
+			break;
+		}
+		case UBX_STATE_HEADER:
+		{
+			handle->ubxHeader[handle->ubxCounter++] = byte;
+			handle->ubxChecksum[0] += byte;
+			handle->ubxChecksum[1] += handle->ubxChecksum[0];
+
+			if(handle->ubxCounter == sizeof(handle->ubxHeader))
+			{
+				length = handle->ubxHeader[2] | (handle->ubxHeader[3] << 8);
+				handle->ubxCounter = 0;
+				handle->ubxState = (length == 0) ? UBX_STATE_CHECKSUM : UBX_STATE_PAYLOAD;
+
+				//Drops too long frame, and waits for next sync characters
+				if(length > UBX_MAX_PAYLOAD)
+				{
+					handle->ubxState = UBX_STATE_IDLE;
+					handle->stats.ubxOverflows++;
+				}
+			}
+			break;
+		}
+		case UBX_STATE_PAYLOAD:
+		{
+			if(handle->ubxCounter < sizeof(handle->ubxPayload))
+			{
+				handle->ubxPayload[handle->ubxCounter] = byte;
+			}
+			handle->ubxChecksum[0] += byte;
+			handle->ubxChecksum[1] += handle->ubxChecksum[0];
+
+			if(++handle->ubxCounter == length)
+			{
+				handle->ubxCounter = 0;
+				handle->ubxState = UBX_STATE_CHECKSUM;
+			}
+			break;
+		}
+		case UBX_STATE_CHECKSUM:
+		{
+			if(byte != handle->ubxChecksum[handle->ubxCounter++])
+			{
+				handle->ubxState = UBX_STATE_IDLE;
+				handle->stats.ubxCorrupted++;
+			}
+			else if(handle->ubxCounter == sizeof(handle->ubxChecksum))
+			{
+				handle->ubxState = UBX_STATE_IDLE;
+				handle->stats.ubxFrames++;
+
+				//Acknowledge contains class and ID of the acknowledged message
+				if(handle->ubxHeader[0] == UBX_CLASS_ACK && length == sizeof(handle->ubxPayload))
+				{
+					handle->ackMessage = (handle->ubxPayload[0] << 8) | handle->ubxPayload[1];
+					handle->ackStatus = (handle->ubxHeader[1] == UBX_ACK_ACK) ? NEO_ACK_ACK : NEO_ACK_NAK;
+				}
+				//Expected message is decoded while processing, if the frame was placed in the ring
+				else if(is_expected(handle, type = ubx_type(UBX_MESSAGE(handle->ubxHeader[0], handle->ubxHeader[1]), length)))
+				{
+					if(handle->ubxDropped)
+					{
+						handle->stats.dropped++;
+					}
+					else
+					{
+						slot->type = type;
+						slot->talker = NEO_TALKER_ALL;
+						slot->checksum = 0;
+						slot->fieldsCount = 0;
+						queue_publish(handle, 8 + length);
+					}
+				}
+			}
+			break;
+		}
+		default:
+		{
+			handle->ubxState = UBX_STATE_IDLE;
+		}
+	}
+
+	return 1;
+}
+
+
+/**
+  * @brief   This function updates checksum of UBX frame with the data (8-Bit Fletcher Algorithm)
+  * @param   *data: Pointer to the data
+  * @param   length: Length of the data
+  * @param   *checksum: Checksum to update, 2 bytes
+  * @retval  None
+  */
+static void ubx_checksum(const uint8_t *data, uint16_t length, uint8_t *checksum)
+{
+	for(uint32_t i = 0; i < length; i++)
+	{
+		checksum[0] += data[i];
+		checksum[1] += checksum[0];
+	}
+}
+
+
+/**
+  * @brief   This function finds type of UBX message by its class and ID
+  * @param   message: Class and ID of the message, packed with UBX_MESSAGE
+  * @param   length: Length of the payload
+  * @retval  MessagesTypes_t Type of the message, EMPTY - unsupported message or unexpected length
+  */
+static MessagesTypes_t ubx_type(uint16_t message, uint16_t length)
+{
+	for(MessagesTypes_t type = FIRST_UBX_TYPE; type <= LAST_MESSAGE_TYPE; type++)
+	{
+		if(MESSAGE_UBX_IDS[type] == message)
+		{
+			//Aiding data of satellite, that has no data, is only its header
+			if((type == AID_ALM || type == AID_EPH) && length == AID_EMPTY_LENGTH)
+			{
+				return type;
+			}
+			return (length == UBX_PAYLOAD_LENGTHS[type - FIRST_UBX_TYPE]) ? type : EMPTY;
+		}
+	}
+
+	return EMPTY;
+}
+
+
+/**
+  * @brief   This function decodes payload of UBX frame to the package
+  * @note	 Packages are declared as payloads, so payload is copied as is (MCU must be little-endian).
+  * 		 Shorter payload (aiding data of satellite, that has no data) leaves the rest of the package zeroed.
+  * @param   *frame: Received frame, including sync characters
+  * @param   message_type: Type of the message, one of UBX messages
+  * @param   *package: Pointer to the package
+  * @retval  None
+  */
+static void ubx_decode(const NEO6M_SentenceView_t *frame, MessagesTypes_t message_type, void *package)
+{
+	uint8_t *member = (uint8_t *)package;
+	uint16_t length = frame->length[0] + frame->length[1] - 8;
+
+	if(length > UBX_PAYLOAD_LENGTHS[message_type - FIRST_UBX_TYPE])
+	{
+		length = UBX_PAYLOAD_LENGTHS[message_type - FIRST_UBX_TYPE];
+	}
+
+	//Payload follows sync characters, class, ID and length
+	for(uint16_t i = 0; i < length; i++)
+	{
+		member[i] = (uint8_t)view_char(frame, 6 + i);
+	}
+}
+
+
+/**
+  * @brief   This function sets output rate of NMEA or UBX message in the module with UBX-CFG-MSG
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @param   rate: Output rate of the message, 0 - message is disabled, 1 - message is output each epoch
+  * @retval  0 - if module acknowledged, otherwise - 1
+  */
+static uint8_t set_message_rate(NEO6M_Handle_t *handle, MessagesTypes_t message_type, uint8_t rate)
+{
+	uint8_t payload[3] = {MESSAGE_UBX_IDS[message_type] >> 8, (uint8_t)MESSAGE_UBX_IDS[message_type], rate};
+
+	return ubx_send_config(handle, UBX_CFG_MSG, payload, sizeof(payload));
+}
+
+
+/*********************************************************************************************
+ *										Trackers
+ ********************************************************************************************/
+
+/**
+  * @brief   This function passes decoded message to trackers, that need it
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: Type of the message
+  * @param   *sentence: Pointer to the sentence view, that the package was decoded from
+  * @param   *package: Decoded package of the message
+  * @retval  None
+  */
+static void track_message(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NEO6M_SentenceView_t *sentence, const NMEA_Package_t *package)
+{
+	char time;
+
+	if(handle->trackers & NEO_TRACK_SKY)
+	{
+		if(message_type == GSV)
+		{
+			sky_update(handle, &package->gsv);
+		}
+		else if(message_type == GSA)
+		{
+			sky_used(handle, &package->gsa);
+		}
+	}
+
+	if((handle->trackers & NEO_TRACK_EPOCH) && ((EPOCH_MESSAGES >> message_type) & 1))
+	{
+		//Time is the first field of RMC and GGA, module sends it empty until UTC time is known
+		time = sentence->fieldsCount ? view_char(sentence, sentence->fields[0]) : ',';
+		epoch_merge(handle, message_type, package, time != ',' && time != '*');
+	}
+
+	if((handle->trackers & NEO_TRACK_AIDING) && ((AIDING_MESSAGES >> message_type) & 1))
+	{
+		aiding_save(handle, message_type, package);
+	}
+}
+
+
+/**
+  * @brief   This function polls aiding data (position and time, almanac and ephemeris of all satellites)
+  * @note	 Non-volatile memory is prepared with NEO6M_AidingBeginCallBack before the poll (e.g. flash sector
+  * 		 is erased), so only fast writes are done while responses are received. Responses are received
+  * 		 as usual, and saved by aiding_save as they're processed.
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+static void aiding_poll(NEO6M_Handle_t *handle)
+{
+	handle->aidingPolled = HAL_GetTick();
+
+	if(NEO6M_AidingBeginCallBack())
+	{
+		return;
+	}
+
+	handle->aidingOffset = 0;
+	handle->aidingChecksum[0] = 0;
+	handle->aidingChecksum[1] = 0;
+	handle->aidingSaving = 1;
+
+	//Timeout of the saving is counted after the poll
+	ubx_send(handle, UBX_CLASS_AID, UBX_AID_INI, NULL, 0);
+	ubx_send(handle, UBX_CLASS_AID, UBX_AID_ALM, NULL, 0);
+	ubx_send(handle, UBX_CLASS_AID, UBX_AID_EPH, NULL, 0);
+	handle->aidingPolled = HAL_GetTick();
+}
+
+
+/**
+  * @brief   This function saves polled aiding data to non-volatile memory with NEO6M_AidingWriteCallBack
+  * @note	 Data is saved compactly as a sequence of UBX frames after the header, ready to be injected:
+  * 		 satellites without data are skipped, and AID-INI is saved only with valid position.
+  * 		 Saving is finished by ephemeris of the last satellite, or by NEO6M_AIDING_TIMEOUT if it's lost.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: Type of the message, one of aiding messages
+  * @param   *package: Decoded package of the message
+  * @retval  None
+  */
+static void aiding_save(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NMEA_Package_t *package)
+{
+	uint8_t frame[8 + sizeof(AID_EPH_Package_t)] = {UBX_SYNC_CHAR_1, UBX_SYNC_CHAR_2};
+	uint16_t length = UBX_PAYLOAD_LENGTHS[message_type - FIRST_UBX_TYPE];
+	uint8_t valid;
+	uint8_t last = 0;
+
+	//Responses to user polls aren't saved
+	if(!handle->aidingSaving)
+	{
+		return;
+	}
+
+	switch(message_type)
+	{
+		case AID_INI:
+		{
+			valid = (package->aidIni.flags & UBX_AID_INI_POS) != 0;
+			break;
+		}
+		case AID_ALM:
+		{
+			valid = (package->aidAlm.week != 0);
+			break;
+		}
+		default:
+		{
+			valid = (package->aidEph.how != 0);
+			last = (package->aidEph.svid >= NEO6M_AIDING_MAX_SV);
+		}
+	}
+
+	if(valid && handle->aidingOffset + length + 8 <= AIDING_MAX_LENGTH)
+	{
+		frame[2] = MESSAGE_UBX_IDS[message_type] >> 8;
+		frame[3] = (uint8_t)MESSAGE_UBX_IDS[message_type];
+		frame[4] = (uint8_t)length;
+		frame[5] = (uint8_t)(length >> 8);
+		memcpy(frame + 6, package, length);
+		ubx_checksum(frame + 2, length + 4, frame + 6 + length);
+
+		if(!NEO6M_AidingWriteCallBack(AIDING_HEADER_LENGTH + handle->aidingOffset, frame, length + 8))
+		{
+			ubx_checksum(frame, length + 8, handle->aidingChecksum);
+			handle->aidingOffset += length + 8;
+		}
+	}
+
+	if(last)
+	{
+		aiding_finish(handle);
+	}
+}
+
+
+/**
+  * @brief   This function finishes saving of aiding data, by writing the header with its length and checksum
+  * @note	 Header is written the last, so data, that saving of was interrupted, isn't injected
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+static void aiding_finish(NEO6M_Handle_t *handle)
+{
+	uint8_t header[AIDING_HEADER_LENGTH] = {(uint8_t)handle->aidingOffset, (uint8_t)(handle->aidingOffset >> 8),
+											(uint8_t)(handle->aidingOffset >> 16), (uint8_t)(handle->aidingOffset >> 24),
+											handle->aidingChecksum[0], handle->aidingChecksum[1], 0, 0};
+
+	handle->aidingSaving = 0;
+	NEO6M_AidingWriteCallBack(0, header, sizeof(header));
+}
+
+
+/**
+  * @brief   This function reads saved UBX frame of aiding data, and verifies it
+  * @param   offset: Offset of the frame in non-volatile memory
+  * @param   end: End of saved aiding data
+  * @param   *frame: Buffer for the frame, fits AID-EPH frame
+  * @retval  uint16_t Size of the frame, 0 - if it's broken
+  */
+static uint16_t aiding_read_frame(uint32_t offset, uint32_t end, uint8_t *frame)
+{
+	uint8_t checksum[2] = {0};
+	uint16_t length;
+
+	if(offset + 8 > end || NEO6M_AidingReadCallBack(offset, frame, 6) ||
+	   frame[0] != UBX_SYNC_CHAR_1 || frame[1] != UBX_SYNC_CHAR_2)
+	{
+		return 0;
+	}
+
+	length = frame[4] | (frame[5] << 8);
+	if(!((AIDING_MESSAGES >> ubx_type(UBX_MESSAGE(frame[2], frame[3]), length)) & 1) ||
+	   offset + 8 + length > end || NEO6M_AidingReadCallBack(offset + 6, frame + 6, length + 2))
+	{
+		return 0;
+	}
+
+	ubx_checksum(frame + 2, length + 4, checksum);
+	if(checksum[0] != frame[6 + length] || checksum[1] != frame[7 + length])
+	{
+		return 0;
+	}
+
+	return length + 8;
+}
+
+
+/**
+  * @brief   This function updates satellites of GSV message part in the sky table, as soon as the part is received
+  * @note	 Satellites are found by PRN. When the last part is received, GSV cycle is completed: satellites,
+  * 		 that weren't reported for NEO6M_SATELLITE_MAX_AGE cycles, are removed and NEO6M_SkyCallBack is called.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *gsv: Decoded part of GSV message
+  * @retval  None
+  */
+static void sky_update(NEO6M_Handle_t *handle, const GSV_Package_t *gsv)
+{
+	NEO6M_Sky_t *sky = &handle->sky;
+	const SV_Info_t *sv;
+	uint64_t visible;
+	uint32_t index;
+
+	sky->inView = gsv->noSV;
+
+	//Last part could have less blocks, missing blocks are zero
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		sv = &gsv->repeated_block[i];
+		if(sv->sv == 0 || sv->sv > NEO6M_MAX_PRN)
+		{
+			continue;
+		}
+
+		index = sv->sv - 1;
+		sky->visible |= 1ULL << index;
+		sky->elevation[index] = sv->elv;
+		sky->azimuth[index] = sv->az;
+		sky->cno[index] = sv->cno;
+		sky->lastSeen[index] = sky->epoch;
+	}
+
+	if(gsv->msgNo < gsv->noMsg)
+	{
+		return;
+	}
+
+	//Ages satellites, that weren't reported in this cycle
+	for(visible = sky->visible; visible; visible &= visible - 1)
+	{
+		index = __builtin_ctzll(visible);
+		if((uint16_t)(sky->epoch - sky->lastSeen[index]) >= NEO6M_SATELLITE_MAX_AGE)
+		{
+			sky->visible &= ~(1ULL << index);
+			sky->cno[index] = 0;
+		}
+	}
+
+	sky->epoch++;
+	NEO6M_SkyCallBack(sky);
+}
+
+
+/**
+  * @brief   This function updates satellites used in navigation solution in the sky table
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *gsa: Decoded GSA message
+  * @retval  None
+  */
+static void sky_used(NEO6M_Handle_t *handle, const GSA_Package_t *gsa)
+{
+	uint64_t used = 0;
+
+	for(uint32_t i = 0; i < 12; i++)
+	{
+		if(gsa->sv[i] != 0 && gsa->sv[i] <= NEO6M_MAX_PRN)
+		{
+			used |= 1ULL << (gsa->sv[i] - 1);
+		}
+	}
+
+	handle->sky.used = used;
+}
+
+
+/**
+  * @brief   This function merges decoded message into navigation solution of the epoch
+  * @note	 Epoch is identified by UTC time of RMC and GGA messages, VTG and GSA messages have no time
+  * 		 and are merged into the current epoch. Solution is delivered, when all EPOCH_MESSAGES are merged,
+  * 		 when message of another epoch is received, or by timeout in NEO6M_Process.
+  * 		 Messages of the epoch, that was already delivered by timeout, are dropped, so the solution
+  * 		 of the same UTC time isn't delivered twice. Messages with empty time are never late.
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: Type of the message, one of EPOCH_MESSAGES
+  * @param   *package: Decoded package of the message
+  * @param   time_known: 1 - time field of RMC or GGA message isn't empty
+  * @retval  None
+  */
+static void epoch_merge(NEO6M_Handle_t *handle, MessagesTypes_t message_type, const NMEA_Package_t *package, uint8_t time_known)
+{
+	NEO6M_NavSolution_t *nav = &handle->navSolution;
+	uint32_t time_ms;
+
+	//The same message again means, that the rest of the epoch was lost
+	if((nav->messages >> message_type) & 1)
+	{
+		epoch_deliver(handle);
+	}
+
+	if(message_type == RMC || message_type == GGA)
+	{
+		time_ms = (message_type == RMC) ? package->rmc.timeMs : package->gga.timeMs;
+
+		//Late message of the delivered epoch, messages without time merged after the delivery belong to it too
+		handle->navLate = (time_known && time_ms == handle->navLastTime);
+		if(handle->navLate)
+		{
+			memset(nav, 0, sizeof(NEO6M_NavSolution_t));
+			return;
+		}
+
+		if((nav->messages & ((1UL << RMC) | (1UL << GGA))) && nav->timeMs != time_ms)
+		{
+			epoch_deliver(handle);
+		}
+		nav->timeMs = time_ms;
+		handle->navTimeKnown = time_known;
+	}
+	else if(handle->navLate)
+	{
+		return;
+	}
+
+	if(!nav->messages)
+	{
+		handle->navStart = HAL_GetTick();
+	}
+
+	switch(message_type)
+	{
+		case RMC:
+		{
+			nav->epoch = package->rmc.epoch;
+			nav->status = package->rmc.status;
+			nav->latitude = package->rmc.latitude;
+			nav->longitude = package->rmc.longitude;
+			nav->sog = package->rmc.spd;
+			nav->cog = package->rmc.cog;
+			break;
+		}
+
+		case VTG:
+		{
+			nav->sog = package->vtg.sog;
+			nav->kph = package->vtg.kph;
+			nav->cog = package->vtg.cogt;
+			break;
+		}
+
+		case GGA:
+		{
+			nav->fs = package->gga.fs;
+			nav->noSV = package->gga.noSV;
+			nav->latitude = package->gga.latitude;
+			nav->longitude = package->gga.longitude;
+			nav->msl = package->gga.msl;
+			nav->altref = package->gga.altref;
+
+			//HDOP of GSA has more precision
+			if(!((nav->messages >> GSA) & 1))
+			{
+				nav->hdop = package->gga.hdop;
+			}
+			break;
+		}
+
+		case GSA:
+		{
+			nav->navMode = package->gsa.fs;
+			nav->pdop = package->gsa.pdop;
+			nav->hdop = package->gsa.hdop;
+			nav->vdop = package->gsa.vdop;
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	nav->messages |= 1UL << message_type;
+
+	if((nav->messages & EPOCH_MESSAGES) == EPOCH_MESSAGES)
+	{
+		epoch_deliver(handle);
+	}
+}
+
+
+/**
+  * @brief   This function delivers navigation solution of the epoch and starts the next one
+  * @param   *handler: Pointer to the handler structure.
+  * @retval  None
+  */
+static void epoch_deliver(NEO6M_Handle_t *handle)
+{
+	if(handle->navSolution.messages)
+	{
+		NEO6M_NavSolutionCallBack(&handle->navSolution);
+	}
+
+	//Epoch without RMC and GGA doesn't change time of the last epoch, empty time makes it unknown
+	if(handle->navSolution.messages & ((1UL << RMC) | (1UL << GGA)))
+	{
+		handle->navLastTime = handle->navTimeKnown ? handle->navSolution.timeMs : UINT32_MAX;
+	}
+
+	memset(&handle->navSolution, 0, sizeof(NEO6M_NavSolution_t));
+}
+
+
+/*********************************************************************************************
+ *										Some helpful functions
+ ********************************************************************************************/
+
+/**
+  * @brief   This function decodes fields of the sentence to the package, as described by the package descriptor
+  * @note	 Sentence could have less fields than descriptor (e.g. last part of GSV message), missing members
+  * 		 stay untouched
+  * @param   *sentence: Pointer to the sentence, that must be decoded
+  * @param   *descriptor: Pointer to the package descriptor
+  * @param   *package: Pointer to the package
+  * @retval  None
+  */
+static void nmea_decode(const NEO6M_SentenceView_t *sentence, const PackageDescriptor_t *descriptor, void *package)
+{
+	const FieldDescriptor_t *field = descriptor->fields;
+	const FieldDescriptor_t *end = field + descriptor->fieldsCount;
+	uint8_t scanned = sentence->fieldsCount;
+	uint16_t scan = scanned ? sentence->fields[scanned - 1] : 0;
+	uint8_t *member;
+	uint16_t position;
+	char c;
+
+	for(; field < end; field++)
+	{
+		if(field->index < sentence->fieldsCount)
+		{
+			position = sentence->fields[field->index];
+		}
+		else
+		{
+			//Fields, that positions weren't recorded, are found by scanning from the last found one,
+			//descriptors are sorted by field index
+			while(scan && scanned <= field->index)
+			{
+				scan = view_next_field(sentence, scan);
+				scanned++;
+			}
+			if(!scan)
+			{
+				continue;
+			}
+			position = scan;
+		}
+		member = (uint8_t *)package + field->offset;
+
+		switch(field->format)
+		{
+			case FIELD_CHAR:
+			{
+				c = view_char(sentence, position);
+				*(char *)member = (c == ',' || c == '*') ? 0 : c;
+				break;
+			}
+			case FIELD_U8:
+			{
+				*member = view_to_int(sentence, position, 10);
+				break;
+			}
+			case FIELD_U16:
+			{
+				*(uint16_t *)member = view_to_int(sentence, position, 10);
+				break;
+			}
+			case FIELD_U32:
+			{
+				*(uint32_t *)member = view_to_int(sentence, position, 10);
+				break;
+			}
+			case FIELD_I32:
+			{
+				*(int32_t *)member = view_to_fixed(sentence, position, 0);
+				break;
+			}
+			case FIELD_REAL:
+			{
+#if NEO6M_NUMERIC_FORMAT == NEO6M_NUMERIC_FIXED
+				*(NEO6M_Real_t *)member = view_to_fixed(sentence, position, 3);
+#else
+				*(NEO6M_Real_t *)member = (float)view_to_fixed(sentence, position, 3) / NEO6M_FIXED_SCALE;
+#endif
+				break;
+			}
+			case FIELD_TIME:
+			{
+				*(uint32_t *)member = view_to_time(sentence, position);
+				break;
+			}
+			case FIELD_COORD:
+			{
+				c = (field->index + 1 < sentence->fieldsCount) ? view_char(sentence, sentence->fields[field->index + 1]) : 0;
+				*(NEO6M_Coord_t *)member = view_to_coord(sentence, position, c);
+				break;
+			}
+			case FIELD_STRING:
+			{
+				for(uint8_t i = 0; i + 1 < field->size; i++, position++)
+				{
+					c = view_char(sentence, position);
+					if(c == ',' || c == '*')
+					{
+						break;
+					}
+					*member++ = c;
+				}
+				*member = 0;
+				break;
+			}
+		}
+	}
+
+	//Talker follows '$', checksum was received after '*'
+	member = (uint8_t *)package + descriptor->talkerOffset;
+	member[0] = view_char(sentence, 1);
+	member[1] = view_char(sentence, 2);
+	*(uint16_t *)((uint8_t *)package + descriptor->csOffset) = sentence->checksum;
+
+	if(descriptor->finish != NULL)
+	{
+		descriptor->finish(package);
+	}
+}
+
+
+/**
+  * @brief   This function returns character of the sentence, handling wraparound of the receive ring
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the character in the sentence
+  * @retval  char Character, or '\0' if position is out of the sentence
+  */
+static char view_char(const NEO6M_SentenceView_t *view, uint16_t position)
+{
+	if(position < view->length[0])
+	{
+		return view->data[0][position];
+	}
+
+	position -= view->length[0];
+	return (position < view->length[1]) ? view->data[1][position] : '\0';
+}
+
+
+/**
+  * @brief   This function finds the field, that follows the field at the position
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @retval  uint16_t Position of the next field, 0 if there are no more fields
+  */
+static uint16_t view_next_field(const NEO6M_SentenceView_t *view, uint16_t position)
+{
+	char c;
+
+	while((c = view_char(view, position++)) != '\0')
+	{
+		if(c == ',')
+		{
+			return position;
+		}
+		if(c == '*')
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+  * @brief   This function finds the field of the sentence by its index
+  * @note	 Fields, that positions weren't recorded (more than NEO6M_MAX_FIELDS), are found by scanning
+  * 		 from the last recorded one
+  * @param   *view: Pointer to the sentence
+  * @param   field: Index of the field
+  * @retval  uint16_t Position of the field, 0 if the sentence has no such field
+  */
+static uint16_t view_field(const NEO6M_SentenceView_t *view, uint8_t field)
+{
+	uint16_t position;
+
+	if(field < view->fieldsCount)
+	{
+		return view->fields[field];
+	}
+	if(!view->fieldsCount)
+	{
+		return 0;
+	}
+
+	position = view->fields[view->fieldsCount - 1];
+	for(uint8_t i = view->fieldsCount - 1; position && i < field; i++)
+	{
+		position = view_next_field(view, position);
+	}
+
+	return position;
+}
+
+
+/**
+  * @brief   This function converts field of the sentence to integer
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @param   base: 10 or 16
+  * @retval  int32_t Value of the field, 0 for empty field
+  */
+static int32_t view_to_int(const NEO6M_SentenceView_t *view, uint16_t position, uint8_t base)
+{
+	int32_t value = 0;
+	char c;
+
+	while(1)
+	{
+		c = view_char(view, position++);
+
+		if(c >= '0' && c <= '9')
+		{
+			value = value * base + (c - '0');
+		}
+		else if(base == 16 && c >= 'A' && c <= 'F')
+		{
+			value = value * base + (c - 'A' + 10);
+		}
+		else
+		{
+			return value;
+		}
+	}
+}
+
 
 /**
-  * @brief   This function adds the type of NMEA message to list that determine which callbacks user need
-  * @param   *handler: Pointer to the handler structure.
-  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
-  * @retval  0 - if successfully, otherwise - 1
+  * @brief   This function converts field of the sentence to fixed point number
+  * @note	 Digits after the required decimals are truncated
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @param   decimals: Count of decimals, value is scaled by 10^decimals
+  * @retval  int32_t Value of the field, 0 for empty field
   */
-uint8_t NEO6M_AddExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+static int32_t view_to_fixed(const NEO6M_SentenceView_t *view, uint16_t position, uint8_t decimals)
 {
-	uint8_t flag=1;
+	int32_t value = 0;
+	uint8_t negative = 0, fraction = 0, digits = 0;
+	char c;
 
-	/* Search for empty space */
-	for(uint32_t i = 0; i < EXPECTED_MESSAGES_BUFF_SIZE; i++)
+	if(view_char(view, position) == '-')
 	{
-		if(handle->expectedMessages[i].callback == NULL)
-		{
-			handle->expectedMessages[i] = NMEA_STANDART_MESSAGGES[message_type];
-			handle->expectedMessagesCount++;
-			flag = 0;
-			break;
-		}
+		negative = 1;
+		position++;
 	}
 
-	/* If MCU doesn't receive messages from module yet, starts receiving and updates status flag */
-	if(!flag)
+	while(1)
 	{
-		if(handle->receive_status == NEO_FREE)
+		c = view_char(view, position++);
+
+		if(c >= '0' && c <= '9')
 		{
-			handle->receive_status = NEO_WAITING;
-			if(HAL_UART_Receive_IT(GPS_UART, (uint8_t *)&handle->rcvdByte, 1) != HAL_OK)
+			if(!fraction || digits < decimals)
 			{
-				flag = 1;
+				value = value * 10 + (c - '0');
+				digits += fraction;
 			}
 		}
+		else if(c == '.' && !fraction)
+		{
+			fraction = 1;
+		}
+		else
+		{
+			break;
+		}
 	}
 
-	return flag;
+	for(; digits < decimals; digits++)
+	{
+		value *= 10;
+	}
+
+	return negative ? -value : value;
 }
 
 
 /**
-  * @brief   This function remove the type of NMEA message from the list that determine which callbacks user need
-  * @param   *handler: Pointer to the handler structure.
-  * 		 MessagesTypes_t message_type: One of the supported message type, see @messages_types in .h file
-  * @retval  0 - if successfully, otherwise - 1
+  * @brief   This function converts coordinate field of the sentence (degrees and minutes) to degrees
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @param   nsew: N/S or E/W indicator
+  * @retval  NEO6M_Coord_t Coordinate, negative for S and W
   */
-uint8_t NEO6M_RemoveExpectedMessage(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+static NEO6M_Coord_t view_to_coord(const NEO6M_SentenceView_t *view, uint16_t position, char nsew)
 {
-	/* Check which messages is expects, if this is type that must be removed - changes it to EMPTY */
-	for(uint32_t i = 0; i < EXPECTED_MESSAGES_BUFF_SIZE; i++)
-	{
-		if(handle->expectedMessages[i].type == message_type)
-		{
-			handle->expectedMessages[i] = NMEA_STANDART_MESSAGGES[EMPTY];
-			handle->expectedMessagesCount--;
+#if NEO6M_NUMERIC_FORMAT == NEO6M_NUMERIC_FIXED
+	return coord_to_fixed(view, position, nsew);
+#else
+	return (NEO6M_Coord_t)coord_to_fixed(view, position, nsew) / NEO6M_COORD_SCALE;
+#endif
+}
 
-			//If no messages expects - finishes receiving
-			if(handle->expectedMessagesCount < 1)
-			{
-				handle->receive_status = NEO_FREE;
-			}
-			return 0;
-		}
-	}
 
-	return 1;
+/**
+  * @brief   This function converts coordinate field of the sentence (degrees and minutes) to 1e-7 degrees
+  * @note	 Minutes are taken with 5 decimals, as NEO-6M outputs, and converted with rounding
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @param   nsew: N/S or E/W indicator
+  * @retval  int32_t Coordinate (1e-7 degrees), negative for S and W
+  */
+static int32_t coord_to_fixed(const NEO6M_SentenceView_t *view, uint16_t position, char nsew)
+{
+	int32_t raw = view_to_fixed(view, position, 5);
+	int32_t degrees = raw / 10000000;
+	int32_t coord = degrees * NEO6M_COORD_SCALE + ((raw - degrees * 10000000) * 5 + 1) / 3;
+
+	return (nsew == 'S' || nsew == 'W') ? -coord : coord;
 }
 
 
 /**
-  * @brief   This function receives messages from module byte by byte, and manages message if end sequence happened
-  * @note	 Ensure this is invoked within the appropriate UART callback for proper operation.
-  * @param   *handler: Pointer to the handler structure.
-  * @retval  None
+  * @brief   This function converts time field of the sentence (hhmmss.ss) to milliseconds since midnight
+  * @param   *view: Pointer to the sentence
+  * @param   position: Position of the field
+  * @retval  uint32_t Milliseconds since midnight, 0 for empty field
   */
-void NEO6M_MessageHandler(NEO6M_Handle_t *handler)
+static uint32_t view_to_time(const NEO6M_SentenceView_t *view, uint16_t position)
 {
-	uint32_t checked_types=0;
+	uint32_t hhmmss_ms = view_to_fixed(view, position, 3);
+	uint32_t hours = hhmmss_ms / 10000000;
+	uint32_t minutes = (hhmmss_ms / 100000) % 100;
 
-	//Moves received byte to buffer
-	handler->rxBuff[handler->rxCounter++] = handler->rcvdByte;
+	return hours * 3600000 + minutes * 60000 + hhmmss_ms % 100000;
+}
 
-	//Checks for end sequence
-	if(handler->rcvdByte == '\n')
+
+/**
+  * @brief   This function converts date and time of NMEA message to Unix time
+  * @note	 Year is 2000..2099, days are counted from the table of days before each month
+  * @param   date: Date, ddmmyy
+  * @param   time_ms: Milliseconds since midnight
+  * @retval  int64_t Unix time (ms), 0 if date is empty or invalid
+  */
+static int64_t nmea_to_epoch(uint32_t date, uint32_t time_ms)
+{
+	static const uint16_t DAYS_BEFORE_MONTH[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+	uint32_t day = date / 10000;
+	uint32_t month = (date / 100) % 100;
+	uint32_t year = 2000 + date % 100;
+	uint32_t days;
+
+	if(day < 1 || day > 31 || month < 1 || month > 12)
 	{
-		//Iterates array with expects messages types
-		for(uint32_t i=0; i < EXPECTED_MESSAGES_BUFF_SIZE; i++)
-		{
-			//Check for empty space in array
-			if(handler->expectedMessages[i].type != EMPTY)
-			{
-				//Compares received message type witch expected message type
-				if(!( strncmp(handler->rxBuff, handler->expectedMessages[i].formatter, 6) ))
-				{
-					//Calls appropriate message handler if this is expected message
-					NMEA_MESSAGGES_HANDLERS[handler->expectedMessages[i].type-1](handler, i);
-					break;
-				}
-				checked_types++;
-			}
-			//If count of checked messages types is equal to count of all messages types that expects, then finishes iteration
-			if(checked_types >= handler->expectedMessagesCount)
-			{
-				break;
-			}
-		}
+		return 0;
+	}
 
-		//Resets the rx buffer
-		memset(handler->rxBuff, 0, RX_BUFFER_SIZE);
-		handler->rxCounter = 0;
+	//Leap years since 1970 before this year, every 4th year is leap within 1970..2099
+	days = (year - 1970) * 365 + (year - 1969) / 4 + DAYS_BEFORE_MONTH[month - 1] + day - 1;
+	if(month > 2 && year % 4 == 0)
+	{
+		days++;
 	}
 
-	HAL_UART_Receive_IT(GPS_UART, (uint8_t *)&handler->rcvdByte, 1);
+	return (int64_t)days * 86400000 + time_ms;
 }
 
 
-/*********************************************************************************************
- *								NMEA standard messages handlers
- ********************************************************************************************/
-
 /**
-  * @brief   This function parse particular message and calls appropriate callback
-  * @param   *handler: Pointer to the handler structure.
-  * @param   *message_num: Index of the message
+  * @brief   This function computes members of RMC package, derived from decoded ones
+  * @param   *package: Pointer to the RMC package
   * @retval  None
   */
-static void gga_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static void rmc_finish(void *package)
 {
-	GGA_Package_t package={0};
-
-	nmea_parser(handle->rxBuff, "3dcdc88ffcfc88",
-				&package.time,
-				&package.latitude,
-				&package.ns,
-				&package.longitude,
-				&package.ew,
-				&package.fs,
-				&package.noSV,
-				&package.hdop,
-				&package.msl,
-				&package.uMsl,
-				&package.altref,
-				&package.uSep,
-				&package.diffAge,
-				&package.diffStation,
-				&package.cs);
+	RMC_Package_t *rmc = (RMC_Package_t *)package;
 
-	package.latitude = nmea_to_dec(package.latitude, package.ns);
-	package.longitude = nmea_to_dec(package.longitude, package.ew);
-
-	handle->expectedMessages[message_num].callback(&package);
+	rmc->epoch = nmea_to_epoch(rmc->date, rmc->timeMs);
 }
 
+
 /**
-  * @brief   This function parse particular message and calls appropriate callback
-  * @param   *handler: Pointer to the handler structure.
+  * @brief   This function computes members of PUBX,04 package, derived from decoded ones
+  * @param   *package: Pointer to the PUBX,04 package
   * @retval  None
   */
-static void gll_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static void pubx04_finish(void *package)
 {
-	GLL_Package_t package={0};
-
-	nmea_parser(handle->rxBuff, "dcdc3cc",
-			&package.latitude,
-			&package.ns,
-			&package.longitude,
-			&package.ew,
-			&package.time,
-			&package.valid,
-			&package.mode,
-			&package.cs);
+	PUBX04_Package_t *pubx = (PUBX04_Package_t *)package;
 
-	package.latitude = nmea_to_dec(package.latitude, package.ns);
-	package.longitude = nmea_to_dec(package.longitude, package.ew);
-
-	handle->expectedMessages[message_num].callback(&package);
+	pubx->epoch = nmea_to_epoch(pubx->date, pubx->timeMs);
 }
 
+
 /**
-  * @brief   This function parse particular message and calls appropriate callback
+  * @brief   This function checks if the message type is expected by user
   * @param   *handler: Pointer to the handler structure.
-  * @retval  None
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  1 - if message is expected, otherwise - 0
   */
-static void gsa_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static uint8_t is_expected(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
 {
-	GSA_Package_t package={0};
+	return (expected_messages(handle) >> message_type) & 1;
+}
 
-	nmea_parser(handle->rxBuff, "c8888888888888fff",
-				&package.sMode,
-				&package.fs,
-				&package.sv[0],
-				&package.sv[1],
-				&package.sv[2],
-				&package.sv[3],
-				&package.sv[4],
-				&package.sv[5],
-				&package.sv[6],
-				&package.sv[7],
-				&package.sv[8],
-				&package.sv[9],
-				&package.sv[10],
-				&package.sv[11],
-				&package.pdop,
-				&package.hdop,
-				&package.vdop,
-				&package.cs);
 
-	handle->expectedMessages[message_num].callback(&package);
+/**
+  * @brief   This function checks whether the module should output the message type
+  * @note	 Without module filtering, messages enabled by default are output as well as expected ones
+  * @param   *handler: Pointer to the handler structure.
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  1 - if message is output, otherwise - 0
+  */
+static uint8_t is_output(NEO6M_Handle_t *handle, MessagesTypes_t message_type)
+{
+	return (!handle->moduleFiltering && ((DEFAULT_MESSAGES >> message_type) & 1)) || is_expected(handle, message_type);
 }
 
+
 /**
-  * @brief   This function store GSV packets, until all packets will be received, then parses this packets
+  * @brief   This function adds the message type to subscriptions
   * @param   *handler: Pointer to the handler structure.
-  * @retval  None
+  * @param   *subscriptions: Pointer to the subscriptions (packages or sentences)
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
   */
-static void gsv_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static uint8_t subscribe(NEO6M_Handle_t *handle, uint32_t *subscriptions, MessagesTypes_t message_type)
 {
-	static char gsv_buff[300]={0};
-	static size_t gsv_count=0, gsv_buff_len=0;
-	GSV_Package_t package={0};
-	char *ptr, *saveptr;
-
-	//Waits for all packets that must be receive
-	if(gsv_count < gsv_get_noMsg(handle->rxBuff))
+	if(message_type <= EMPTY || message_type > LAST_MESSAGE_TYPE)
 	{
-		strcpy(&gsv_buff[gsv_buff_len], handle->rxBuff);
-		gsv_count++;
-		gsv_buff_len += strlen(handle->rxBuff);
-		return;
+		return 1;
 	}
 
-	//If all packets was received, starts parse this packet one by one, and calls appropriate callback
-	ptr = strtok_r(gsv_buff, "\n", &saveptr);
-	for(uint32_t i=0; i < gsv_count; i++)
-	{
-		nmea_parser(ptr, "8888818881888188818",
-					&package.noMsg,
-					&package.msgNo,
-					&package.noSV,
-					&package.repeated_block[0].sv,
-					&package.repeated_block[0].elv,
-					&package.repeated_block[0].az,
-					&package.repeated_block[0].cno,
-					&package.repeated_block[1].sv,
-					&package.repeated_block[1].elv,
-					&package.repeated_block[1].az,
-					&package.repeated_block[1].cno,
-					&package.repeated_block[2].sv,
-					&package.repeated_block[2].elv,
-					&package.repeated_block[2].az,
-					&package.repeated_block[2].cno,
-					&package.repeated_block[3].sv,
-					&package.repeated_block[3].elv,
-					&package.repeated_block[3].az,
-					&package.repeated_block[3].cno,
-					&package.cs);
-
-		handle->expectedMessages[message_num].callback(&package);
+	return set_subscriptions(handle, subscriptions, *subscriptions | (1UL << message_type));
+}
+
 
-		memset(&package, 0, sizeof(package));
-		ptr = strtok_r(NULL, "\n", &saveptr);
+/**
+  * @brief   This function removes the message type from subscriptions
+  * @param   *handler: Pointer to the handler structure.
+  * @param   *subscriptions: Pointer to the subscriptions (packages or sentences)
+  * @param   message_type: One of the supported message type, see @messages_types in .h file
+  * @retval  0 - if successfully, otherwise - 1
+  */
+static uint8_t unsubscribe(NEO6M_Handle_t *handle, uint32_t *subscriptions, MessagesTypes_t message_type)
+{
+	if(message_type <= EMPTY || message_type > LAST_MESSAGE_TYPE || !((*subscriptions >> message_type) & 1))
+	{
+		return 1;
 	}
 
-	gsv_count = 0;
-	gsv_buff_len = 0;
-	memset(gsv_buff, 0, 300);
+	return set_subscriptions(handle, subscriptions, *subscriptions & ~(1UL << message_type));
 }
 
+
 /**
-  * @brief   This function parse particular message and calls appropriate callback
+  * @brief   This function changes subscriptions, starts receiving if some messages are expected and stops it otherwise
+  * @note	 If module filtering is enabled, messages, that become expected or not expected, are enabled or
+  * 		 disabled in the module
   * @param   *handler: Pointer to the handler structure.
-  * @retval  None
+  * @param   *subscriptions: Pointer to the subscriptions (packages, sentences or trackers)
+  * @param   value: New subscriptions, bit per message type
+  * @retval  0 - if successfully, otherwise - 1
   */
-static void rmc_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static uint8_t set_subscriptions(NEO6M_Handle_t *handle, uint32_t *subscriptions, uint32_t value)
 {
-	RMC_Package_t package={0};
+	uint32_t expected = expected_messages(handle);
+	uint32_t changed;
+	uint8_t flag=0;
+
+	*subscriptions = value;
+	changed = expected ^ expected_messages(handle);
+	expected ^= changed;
+
+	/* If MCU doesn't receive messages from module yet, starts receiving and updates status flag */
+	if(expected && handle->receive_status == NEO_FREE)
+	{
+		handle->receive_status = NEO_WAITING;
+		flag = start_receive(handle);
+	}
+
+	//Without module filtering, messages enabled by default are output anyway
+	if(!handle->moduleFiltering)
+	{
+		changed &= ~DEFAULT_MESSAGES;
+	}
+	changed &= ~POLLED_MESSAGES;
 
-	nmea_parser(handle->rxBuff, "3cdcdcff3fcc",
-				&package.time,
-				&package.status,
-				&package.latitude,
-				&package.ns,
-				&package.longitude,
-				&package.ew,
-				&package.spd,
-				&package.cog,
-				&package.date,
-				&package.mv,
-				&package.mvE,
-				&package.mode,
-				&package.cs);
+	/* Enables or disables the messages in the module, while acknowledge still could be received */
+	if(!flag)
+	{
+		for(MessagesTypes_t type = GLL; type <= LAST_MESSAGE_TYPE; type++)
+		{
+			if((changed >> type) & 1)
+			{
+				flag |= set_message_rate(handle, type, (expected >> type) & 1);
+			}
+		}
+	}
 
-	package.latitude = nmea_to_dec(package.latitude, package.ns);
-	package.longitude = nmea_to_dec(package.longitude, package.ew);
+	//If no messages expects - finishes receiving
+	if(!expected && handle->receive_status == NEO_WAITING)
+	{
+		handle->receive_status = NEO_FREE;
+		stop_receive(handle);
+	}
 
-	handle->expectedMessages[message_num].callback(&package);
+	return flag;
 }
 
+
 /**
-  * @brief   This function parse particular message and calls appropriate callback
+  * @brief   This function returns all messages types, that are expected by user or trackers
   * @param   *handler: Pointer to the handler structure.
-  * @retval  None
+  * @retval  uint32_t Expected messages types, bit per type
   */
-static void vtg_handle(NEO6M_Handle_t *handle, uint32_t message_num)
+static uint32_t expected_messages(NEO6M_Handle_t *handle)
 {
-	VTG_Package_t package={0};
-
-	nmea_parser(handle->rxBuff, "fc8cfcfcc",
-			&package.cogt,
-			&package.true,
-			&package.cogm,
-			&package.magnetic,
-			&package.sog,
-			&package.knots,
-			&package.kph,
-			&package.kilometers,
-			&package.mode,
-			&package.cs);
-
-	handle->expectedMessages[message_num].callback(&package);
+	return handle->subscriptions | handle->sentenceSubscriptions | handle->trackingSubscriptions;
 }
 
 
-/*********************************************************************************************
- *										Some helpful functions
- ********************************************************************************************/
-
 /**
-  * @brief   This function converts the 'Minutes' and 'Fractional Minutes' parts to decimal format
-  * @param   deg_coord: Coordinate that must be comverted
-  * @param   nsew: N/S or E/W indicator
-  * @retval  decimal format of coordinate
+  * @brief   This function finds the supported message type by address field of the sentence
+  * @note	 Type is found by perfect hash of the formatter, then the formatter is compared. Talker doesn't
+  * 		 matter, so e.g. $GPRMC and $GNRMC are both RMC messages.
+  * @param   address: Talker and formatter of the sentence, packed with NMEA_ADDRESS_PACK
+  * @retval  MessagesTypes_t Type of the message, EMPTY - if it's not supported
   */
-static double nmea_to_dec(double deg_coord, char nsew)
+static MessagesTypes_t message_type(uint32_t address)
 {
-    int degree = (int)(deg_coord/100);
-    double minutes = deg_coord - degree*100;
-    double dec_deg = minutes / 60;
-    double decimal = degree + dec_deg;
+	uint32_t formatter = address & NMEA_FORMATTER_MASK;
+	MessagesTypes_t type = NMEA_FORMATTER_TYPES[NMEA_FORMATTER_HASH(formatter)];
 
-    if (nsew == 'S' || nsew == 'W')
-    {
-        decimal *= -1;
-    }
-    return decimal;
+	return (NMEA_FORMATTERS[type] == formatter) ? type : EMPTY;
 }
 
 
 /**
-  * @brief   This is universal NMEA parser
-  * @param   *package: Pointer to the string, that must be parsed
-  * @param   *package: Pointer to the string with formats(f - float,
-  * c - char, 8 - uint8_t, d - double, 1 - uint16_t, 3 - uint32_t)
-  * @param   args: pointers to appropriate structure arguments
-  * @retval  None
+  * @brief   This function finds type of u-blox proprietary sentence by its message ID
+  * @param   id1: First character of the message ID
+  * @param   id2: Second character of the message ID
+  * @retval  MessagesTypes_t Type of the message, EMPTY - unsupported message
   */
-static void nmea_parser(char *package, char *formats, ...)
+static MessagesTypes_t pubx_type(char id1, char id2)
 {
-	va_list args;
-	char *ptr = package;
-
-	va_start(args, formats);
+	if(id1 != '0')
+	{
+		return EMPTY;
+	}
 
-	for(uint32_t i=0; i < strlen(formats); i++)
+	switch(id2)
 	{
-		switch(formats[i])
-		{
-			case 'f':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, float *) = strtod(++ptr, NULL);
-				break;
-			}
-			case 'c':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, char *) = *++ptr;
-				break;
-			}
-			case '8':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, uint8_t *) = strtol(++ptr, NULL, 10);
-				break;
-			}
-			case 'd':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, double *) = strtod(++ptr, NULL);
-				break;
-			}
-			case '1':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, uint16_t *) = strtol(++ptr, NULL, 10);
-				break;
-			}
-			case '3':
-			{
-				ptr = strchr(ptr, ',');
-				*va_arg(args, uint32_t *) = strtol(++ptr, NULL, 10);
-				break;
-			}
-			default:
-			{
-				*va_arg(args, uint8_t *) = 0;
-			}
-		}
+		case '0':
+			return PUBX00;
+		case '3':
+			return PUBX03;
+		case '4':
+			return PUBX04;
+		default:
+			return EMPTY;
 	}
+}
 
-	ptr = strchr(package, '*');
-	*va_arg(args, uint16_t *) = strtol(++ptr, NULL, 16);
 
-	va_end(args);
+/**
+  * @brief   This function finds the talker by address field of the sentence
+  * @param   address: Talker and formatter of the sentence, packed with NMEA_ADDRESS_PACK
+  * @retval  Talker_t Talker of the message, see @talkers
+  */
+static Talker_t message_talker(uint32_t address)
+{
+	switch(address >> NMEA_TALKER_SHIFT)
+	{
+		case NMEA_TALKER('G', 'P'):
+			return NEO_TALKER_GP;
+		case NMEA_TALKER('G', 'L'):
+			return NEO_TALKER_GL;
+		case NMEA_TALKER('G', 'A'):
+			return NEO_TALKER_GA;
+		case NMEA_TALKER('B', 'D'):
+		case NMEA_TALKER('G', 'B'):
+			return NEO_TALKER_BD;
+		case NMEA_TALKER('G', 'N'):
+			return NEO_TALKER_GN;
+		default:
+			return NEO_TALKER_OTHER;
+	}
 }
 
 
 /**
-  * @brief   This function return number of GPGSV messages being output
-  * @param   *package: Pointer to the string, were noMsg must be found
-  * @retval  uint8_t Number of messages
+  * @brief   This function return index of the UART instance in the array of handles
+  * @note	 Bits 10..12 of the address are unique within APB1 and APB2 UARTs, bit 16 distinguishes APB2
+  * @param   *huart: Pointer to the UART handle
+  * @retval  uint32_t Index of the UART
   */
-static uint8_t gsv_get_noMsg(char *buff)
+static uint32_t uart_index(UART_HandleTypeDef *huart)
 {
-	return strtol(&buff[7], NULL, 10);
+	uint32_t address = (uint32_t)huart->Instance;
+
+	return ((address >> 10) & 0x7) | ((address >> 13) & 0x8);
 }
 
 
@@ -520,3 +3116,140 @@ __weak void NEO6M_VTGCallBack(void *package)
 {
 
 }
+
+__weak void NEO6M_DTMCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_GBSCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_PUBX00CallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_PUBX03CallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_PUBX04CallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_NAV_POSLLHCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_NAV_VELNEDCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_NAV_SOLCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_NAV_TIMEUTCCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_NAV_DOPCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_AID_INICallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_AID_ALMCallBack(void *package)
+{
+
+}
+
+__weak void NEO6M_AID_EPHCallBack(void *package)
+{
+
+}
+
+
+/**
+  * @brief   This is callback function, that calls whenever messages expected as sentences receive
+  * @details This is a weak function and should be overridden in the user application. Fields of the
+  *          sentence are decoded only when they are read with NEO6M_GetChar, NEO6M_GetInt, NEO6M_GetReal
+  *          or NEO6M_GetCoord, decoded values are cached within the sentence.
+  * @note    The sentence is valid only within the callback
+  * @param  *sentence: Pointer to the received sentence.
+  * @retval  None
+  */
+__weak void NEO6M_SentenceCallBack(NEO6M_Sentence_t *sentence)
+{
+
+}
+
+
+/**
+  * @brief   This is callback function, that calls whenever the sky table is updated with all parts of GSV message
+  * @details This is a weak function and should be overridden in the user application, NEO_TRACK_SKY tracker
+  *          must be enabled with NEO6M_SetTracking
+  * @param  *sky: Pointer to the sky table of the handle.
+  * @retval  None
+  */
+__weak void NEO6M_SkyCallBack(const NEO6M_Sky_t *sky)
+{
+
+}
+
+
+/**
+  * @brief   This is callback function, that calls once per epoch with navigation solution merged from
+  *          RMC, VTG, GGA and GSA messages of the epoch
+  * @details This is a weak function and should be overridden in the user application, NEO_TRACK_EPOCH tracker
+  *          must be enabled with NEO6M_SetTracking. Solution is also delivered by timeout, if some messages
+  *          of the epoch were lost, messages of the solution show which ones were merged.
+  * @param  *solution: Pointer to the navigation solution.
+  * @retval  None
+  */
+__weak void NEO6M_NavSolutionCallBack(const NEO6M_NavSolution_t *solution)
+{
+
+}
+
+
+/**
+  * @brief   These are callback functions, that prepare, write and read aiding data in non-volatile memory
+  *          (flash sector, EEPROM, backup SRAM)
+  * @details These are weak functions and should be overridden in the user application, if NEO_TRACK_AIDING
+  *          tracker or NEO6M_RestoreAiding is used. Begin callback is called before aiding data is polled,
+  *          slow operations (e.g. flash sector erase) must be done there, since writes are done while data
+  *          is received. Frames are written sequentially after 8 bytes of header, and the header (offset 0)
+  *          is written the last. Up to 5.2 KB are written.
+  * @param  offset: Offset of the data in the memory
+  * @param  *data: Pointer to the data
+  * @param  length: Length of the data
+  * @retval  0 - if successfully, otherwise - 1 (begin failure skips the poll)
+  */
+__weak uint8_t NEO6M_AidingBeginCallBack(void)
+{
+	return 1;
+}
+
+__weak uint8_t NEO6M_AidingWriteCallBack(uint32_t offset, const uint8_t *data, uint16_t length)
+{
+	return 1;
+}
+
+__weak uint8_t NEO6M_AidingReadCallBack(uint32_t offset, uint8_t *data, uint16_t length)
+{
+	return 1;
+}